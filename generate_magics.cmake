@@ -20,4 +20,5 @@ if(NOT EXISTS "${CMAKE_SOURCE_DIR}/src/magic_squares.h")
 	add_dependencies(tests           generate_magics)
 	add_dependencies(${PROJECT_NAME} generate_magics)
 	add_dependencies(perft           generate_magics)
+	add_dependencies(book_builder    generate_magics)
 endif()
@@ -0,0 +1,74 @@
+#include <doctest/doctest.h>
+
+#include "move_unmove.h"
+#include "nnue/Accumulator.h"
+#include "nnue/Neural_network.h"
+#include "State.h"
+
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace engine;
+
+namespace
+{
+	// makes the moves one by one and takes them back again, the accumulator kept on the stack has to equal one
+	// computed from scratch at every ply on the way
+	void check_line(State& state, Accumulator_stack& accumulators, const Neural_network& neural_network, const std::string_view moves)
+	{
+		std::istringstream move_stream{std::string{moves}};
+		std::vector<Move> made_moves;
+		for(Move move; move_stream>>move;)
+		{
+			CAPTURE(made_moves.size());
+			make(state, accumulators, move);
+			made_moves.push_back(move);
+			CHECK(accumulators.current(state, neural_network)==fresh_accumulator(state, neural_network));
+		}
+		while(!made_moves.empty())
+		{
+			CAPTURE(made_moves.size());
+			unmove(state, accumulators);
+			made_moves.pop_back();
+			CHECK(accumulators.current(state, neural_network)==fresh_accumulator(state, neural_network));
+		}
+	}
+}
+
+TEST_SUITE("Accumulator.h")
+{
+	TEST_CASE("Accumulator_stack follows make and unmove")
+	{
+		// CMake fetches the default net, without it there is nothing to test
+		const auto neural_network{Neural_network::load_default()};
+		if(!neural_network)
+		{
+			MESSAGE(neural_network.error());
+			return;
+		}
+		State state{"r3k2r/1P6/8/3pP3/8/8/6p1/R3K2R w KQkq d6 0 1"};
+		Accumulator_stack accumulators{state, *neural_network};
+
+		// en passant, castling on both sides, a capturing promotion for each side and king moves, some of them back
+		// to squares the king already stood on
+		constexpr std::string_view line{"e5d6 e8g8 b7a8q g2h1n e1c1 g8g7 c1b1 g7g8 b1c1 g8h8 c1d2 h8g8"};
+		check_line(state, accumulators, *neural_network, line);
+		CHECK(state==State{"r3k2r/1P6/8/3pP3/8/8/6p1/R3K2R w KQkq d6 0 1"});
+
+		SUBCASE("the refresh cache is reused on another board")
+		{
+			// the kings return to d2, g7 and g8, whose cache entries still hold the board of the first line
+			check_line(state, accumulators, *neural_network, "e5d6 e8g8 b7b8q g2g1q e1d2 g8g7 d2d3 g7g8 d3d2 g8g7 d2c2 g7g8 c2d2");
+		}
+
+		SUBCASE("several plies are brought up to date at once")
+		{
+			std::istringstream move_stream{std::string{line}};
+			for(Move move; move_stream>>move;)
+				make(state, accumulators, move);
+			CHECK(accumulators.current(state, *neural_network)==fresh_accumulator(state, *neural_network));
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#include <doctest/doctest.h>
+
+#include "nnue/Architecture.h"
+#include "nnue/feature_sets.h"
+#include "Position.h"
+
+using namespace engine;
+
+TEST_SUITE("Architecture.h")
+{
+	TEST_CASE("feature indexes match Stockfish")
+	{
+		// sq + PS_END*ksq + the piece offset, Ke1 and Pe2 of the white perspective
+		CHECK(HalfKP::feature_index(Piece::pawn, algebraic_to_position("e2"), algebraic_to_position("e1"), Side::white, Side::white)==2577);
+
+		// (sq^orientation) + the piece plane + the king bucket of 11*64 features
+		SUBCASE("HalfKAv2_hm")
+		{
+			// Ke1 is bucket 31, own pieces come first
+			CHECK(HalfKAv2_hm::feature_index(Piece::pawn, algebraic_to_position("e2"), algebraic_to_position("e1"), Side::white, Side::white)==21836);
+			// the black perspective flips the ranks, Ke8 is bucket 31 too and the white pawn is an enemy piece
+			CHECK(HalfKAv2_hm::feature_index(Piece::pawn, algebraic_to_position("e2"), algebraic_to_position("e8"), Side::white, Side::black)==21940);
+			// a king on the queenside mirrors the files, Kc1 is bucket 30
+			CHECK(HalfKAv2_hm::feature_index(Piece::knight, algebraic_to_position("f6"), algebraic_to_position("c1"), Side::black, Side::white)==21354);
+			// both kings share the last plane
+			CHECK(HalfKAv2_hm::feature_index(Piece::king, algebraic_to_position("g1"), algebraic_to_position("g1"), Side::white, Side::white)==21062);
+			CHECK(HalfKAv2_hm::feature_index(Piece::king, algebraic_to_position("g8"), algebraic_to_position("g1"), Side::black, Side::white)==21118);
+			// Ka8 is bucket 0
+			CHECK(HalfKAv2_hm::feature_index(Piece::queen, algebraic_to_position("d4"), algebraic_to_position("a8"), Side::white, Side::white)==540);
+		}
+	}
+
+	TEST_CASE("layer_stack()")
+	{
+		CHECK(HalfKP_256x2_32_32::layer_stack(2)==0);
+		CHECK(HalfKP_256x2_32_32::layer_stack(32)==0);
+
+		// like Stockfish, (pieces-1)/4 with 8 stacks
+		using Layer_stacks=Architecture<HalfKAv2_hm, 1024, 8, Dimensions{2048, 16}, Dimensions{16, 32}, Dimensions{32, 1}>;
+		CHECK(Layer_stacks::description()=="HalfKAv2_hm 1024x2-16-32 with 8 layer stacks");
+		CHECK(Layer_stacks::layer_stack(2)==0);
+		CHECK(Layer_stacks::layer_stack(4)==0);
+		CHECK(Layer_stacks::layer_stack(5)==1);
+		CHECK(Layer_stacks::layer_stack(8)==1);
+		CHECK(Layer_stacks::layer_stack(9)==2);
+		CHECK(Layer_stacks::layer_stack(28)==6);
+		CHECK(Layer_stacks::layer_stack(29)==7);
+		CHECK(Layer_stacks::layer_stack(32)==7);
+	}
+}
@@ -0,0 +1,361 @@
+#include "Book_builder.h"
+
+#include "Move_generator.h"
+#include "move_unmove.h"
+#include "Transposition_table.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+
+namespace engine::book_builder
+{
+	namespace
+	{
+		[[nodiscard]] constexpr bool is_space(const char character) noexcept
+		{
+			return character==' ' || character=='\n' || character=='\r' || character=='\t';
+		}
+
+		// chunks of a file are cut where a game starts
+		[[nodiscard]] std::size_t next_game_start(const std::string_view text, const std::size_t offset) noexcept
+		{
+			if(offset==0)
+				return 0;
+			const auto position{text.find("\n[Event ", offset-1)};
+			return position==std::string_view::npos? text.size() : position+1;
+		}
+
+		[[nodiscard]] std::optional<Result> to_result(const std::string_view token) noexcept
+		{
+			if(token=="1-0")
+				return Result::white_win;
+			if(token=="0-1")
+				return Result::black_win;
+			if(token=="1/2-1/2")
+				return Result::draw;
+			if(token=="*")
+				return Result::unknown;
+			return std::nullopt;
+		}
+
+		[[nodiscard]] std::optional<Piece> to_piece(const char character) noexcept
+		{
+			switch(character)
+			{
+				case 'K': return Piece::king;
+				case 'Q': return Piece::queen;
+				case 'R': return Piece::rook;
+				case 'B': return Piece::bishop;
+				case 'N': return Piece::knight;
+				default: return std::nullopt;
+			}
+		}
+
+		void write_big_endian(std::ostream& os, const std::uint64_t value, const std::size_t size)
+		{
+			for(std::size_t byte{size}; byte-->0;)
+				os.put(static_cast<char>(value>>(8*byte)));
+		}
+	}
+
+	// matched against the legal moves so only the distinguishing parts need parsing
+	std::optional<Move> parse_san(const State& state, std::string_view san) noexcept
+	{
+		while(!san.empty() && std::string_view{"+#!?"}.contains(san.back()))
+			san.remove_suffix(1);
+
+		const auto legal_moves{generate_moves<Moves_type::legal>(state)};
+		const auto find_legal=[&](const Move& move) -> std::optional<Move>
+		{
+			if(std::ranges::find(legal_moves, move)==legal_moves.end())
+				return std::nullopt;
+			return move;
+		};
+
+		if(san=="O-O" || san=="0-0" || san=="O-O-O" || san=="0-0-0")
+		{
+			const Position king_square{state.sides[state.side_to_move].pieces[Piece::king].lsb_square()};
+			return find_legal(Move{king_square, Position{king_square.rank_, san.size()==3? 6 : 2}});
+		}
+
+		Piece piece{Piece::pawn};
+		if(!san.empty() && to_piece(san.front()))
+		{
+			piece=to_piece(san.front()).value();
+			san.remove_prefix(1);
+		}
+		std::optional<Piece> promotion_piece;
+		if(!san.empty() && to_piece(san.back()))
+		{
+			promotion_piece=to_piece(san.back());
+			san.remove_suffix(1);
+			if(!san.empty() && san.back()=='=')
+				san.remove_suffix(1);
+		}
+		if(san.size()<2)
+			return std::nullopt;
+		const char destination_file{san[san.size()-2]}, destination_rank{san.back()};
+		if(destination_file<'a' || destination_file>'h' || destination_rank<'1' || destination_rank>'8')
+			return std::nullopt;
+		const Position destination_square{destination_rank-'1', destination_file-'a'};
+		san.remove_suffix(2);
+
+		std::optional<int> from_file, from_rank;
+		for(const char character : san)
+		{
+			if(character>='a' && character<='h')
+				from_file=character-'a';
+			else if(character>='1' && character<='8')
+				from_rank=character-'1';
+			else if(character!='x')
+				return std::nullopt;
+		}
+
+		std::optional<Move> found_move;
+		for(const auto& move : legal_moves)
+		{
+			const Position from_square{move.from_square()};
+			if(move.destination_square()!=destination_square || state.piece_at(from_square, state.side_to_move)!=piece
+				|| (from_file && from_square.file_!=*from_file) || (from_rank && from_square.rank_!=*from_rank)
+				|| move.is_promotion()!=promotion_piece.has_value() || (promotion_piece && move.promotion_piece()!=*promotion_piece))
+				continue;
+			if(found_move)
+				return std::nullopt;
+			found_move=move;
+		}
+		return found_move;
+	}
+
+	std::vector<std::string_view> split_into_chunks(const std::string_view text, const std::size_t chunk_count)
+	{
+		std::vector<std::string_view> chunks;
+		for(std::size_t chunk{0}; chunk<chunk_count; ++chunk)
+		{
+			const auto begin{next_game_start(text, text.size()*chunk/chunk_count)}, end{next_game_start(text, text.size()*(chunk+1)/chunk_count)};
+			if(begin<end)
+				chunks.push_back(text.substr(begin, end-begin));
+		}
+		return chunks;
+	}
+
+	void Pgn_parser::parse(const std::string_view text)
+	{
+		text_=text;
+		index_=0;
+		while(skip_to_game())
+			parse_game();
+	}
+
+	void Pgn_parser::skip_line() noexcept
+	{
+		const auto end{text_.find('\n', index_)};
+		index_=end==std::string_view::npos? text_.size() : end+1;
+	}
+
+	bool Pgn_parser::skip_to_game() noexcept
+	{
+		while(index_<text_.size() && !(text_[index_]=='[' && at_line_start()))
+			skip_line();
+		return index_<text_.size();
+	}
+
+	// the tag section, only the starting position and the result matter
+	void Pgn_parser::parse_tags(std::string_view& fen, Result& result) noexcept
+	{
+		while(index_<text_.size())
+		{
+			if(is_space(text_[index_]))
+			{
+				++index_;
+				continue;
+			}
+			if(text_[index_]!='[')
+				return;
+			const auto line_end{std::min(text_.find('\n', index_), text_.size())};
+			const std::string_view line{text_.substr(index_, line_end-index_)};
+			const auto value_begin{line.find('"')}, value_end{line.rfind('"')};
+			if(value_begin!=std::string_view::npos && value_end>value_begin)
+			{
+				const std::string_view value{line.substr(value_begin+1, value_end-value_begin-1)};
+				if(line.starts_with("[FEN "))
+					fen=value;
+				else if(line.starts_with("[Result "))
+					result=to_result(value).value_or(Result::unknown);
+			}
+			index_=line_end;
+		}
+	}
+
+	// the next move or result in the movetext, comments, variations and annotations are skipped
+	std::string_view Pgn_parser::next_token() noexcept
+	{
+		while(index_<text_.size())
+		{
+			const char character{text_[index_]};
+			if(is_space(character) || character==')')
+				++index_;
+			else if(character=='[' && at_line_start())
+				return {};
+			else if(character==';' || (character=='%' && at_line_start()))
+				skip_line();
+			else if(character=='{')
+			{
+				const auto end{text_.find('}', index_)};
+				index_=end==std::string_view::npos? text_.size() : end+1;
+			}
+			else if(character=='(')
+			{
+				for(int depth{0}; index_<text_.size(); ++index_)
+				{
+					if(text_[index_]=='{')
+						index_=std::min(text_.find('}', index_), text_.size()-1);
+					else if(text_[index_]=='(')
+						++depth;
+					else if(text_[index_]==')' && --depth==0)
+						break;
+				}
+			}
+			else
+			{
+				const auto begin{index_};
+				while(index_<text_.size() && !is_space(text_[index_]) && !std::string_view{"{}();"}.contains(text_[index_]))
+					++index_;
+				std::string_view token{text_.substr(begin, index_-begin)};
+				if(token.front()=='$')
+					continue;
+				// move numbers can be attached to the move, "12.e4" or "12...e5"
+				if(token.front()>='0' && token.front()<='9' && !to_result(token))
+				{
+					token.remove_prefix(std::min(token.find_last_of('.')+1, token.size()));
+					if(token.empty())
+						continue;
+				}
+				return token;
+			}
+		}
+		return {};
+	}
+
+	void Pgn_parser::parse_game()
+	{
+		std::string_view fen{starting_fen};
+		Result result{Result::unknown};
+		parse_tags(fen, result);
+
+		// parsing a fen is far slower than copying the starting position
+		std::optional<State> state;
+		if(fen==starting_fen)
+			state.emplace(starting_state_);
+		else
+		{
+			try
+			{
+				state.emplace(fen);
+			}
+			catch(const std::invalid_argument&)
+			{
+			}
+		}
+
+		game_moves_.clear();
+		for(std::string_view token{next_token()}; !token.empty(); token=next_token())
+		{
+			if(const auto token_result{to_result(token)})
+			{
+				if(*token_result!=Result::unknown)
+					result=*token_result;
+				break;
+			}
+			if(!state || game_moves_.size()>=max_ply_)
+				continue;
+			const auto move{parse_san(*state, token)};
+			// stop replaying at the first move we cannot follow, the rest of the game is still skipped over
+			if(!move)
+			{
+				state.reset();
+				continue;
+			}
+			game_moves_.push_back({polyglot::hash(*state), Opening_book::to_polyglot_move(*state, *move), state->side_to_move});
+			make(*state, *move);
+		}
+
+		++games_;
+		for(const auto& book_move : game_moves_)
+		{
+			auto& move_statistics{statistics_[book_move]};
+			++move_statistics.games;
+			if(result==Result::draw)
+				++move_statistics.draws;
+			else if((result==Result::white_win && book_move.side==Side::white) || (result==Result::black_win && book_move.side==Side::black))
+				++move_statistics.wins;
+		}
+	}
+
+	void merge(Statistics& total, const Statistics& statistics)
+	{
+		for(const auto& [book_move, move_statistics] : statistics)
+		{
+			auto& total_statistics{total[book_move]};
+			total_statistics.games+=move_statistics.games;
+			total_statistics.wins+=move_statistics.wins;
+			total_statistics.draws+=move_statistics.draws;
+		}
+	}
+
+	// weights follow the usual Polyglot convention of two points a win and one a draw, scaled per position to fit 16 bits,
+	// a move with no points would never be picked from the book
+	std::vector<Opening_book::Entry> to_entries(const Statistics& statistics, const unsigned min_games)
+	{
+		std::vector<Opening_book::Entry> entries;
+		std::vector<std::uint64_t> scores;
+		for(const auto& [book_move, move_statistics] : statistics)
+		{
+			const std::uint64_t score{2ULL*move_statistics.wins+move_statistics.draws};
+			if(move_statistics.games<min_games || score==0)
+				continue;
+			entries.push_back({book_move.key, book_move.move, 0, 0});
+			scores.push_back(score);
+		}
+
+		std::vector<std::size_t> order(entries.size());
+		std::iota(order.begin(), order.end(), std::size_t{0});
+		std::ranges::sort(order, [&](const std::size_t lhs, const std::size_t rhs)
+		{
+			return std::tie(entries[lhs].key, scores[rhs])<std::tie(entries[rhs].key, scores[lhs]);
+		});
+
+		std::vector<Opening_book::Entry> sorted_entries;
+		sorted_entries.reserve(entries.size());
+		for(std::size_t first{0}; first<order.size();)
+		{
+			std::size_t last{first};
+			while(last<order.size() && entries[order[last]].key==entries[order[first]].key)
+				++last;
+			constexpr std::uint64_t max_weight{std::numeric_limits<std::uint16_t>::max()};
+			const std::uint64_t max_score{scores[order[first]]};
+			for(std::size_t index{first}; index<last; ++index)
+			{
+				Opening_book::Entry entry{entries[order[index]]};
+				// scaling down must not round a move that scored to nothing
+				entry.weight=static_cast<std::uint16_t>(max_score>max_weight? std::max<std::uint64_t>(scores[order[index]]*max_weight/max_score, 1) : scores[order[index]]);
+				sorted_entries.push_back(entry);
+			}
+			first=last;
+		}
+		return sorted_entries;
+	}
+
+	void write_book(std::ostream& os, std::span<const Opening_book::Entry> entries)
+	{
+		for(const auto& entry : entries)
+		{
+			write_big_endian(os, entry.key, 8);
+			write_big_endian(os, entry.move, 2);
+			write_big_endian(os, entry.weight, 2);
+			write_big_endian(os, entry.learn, 4);
+		}
+	}
+}
@@ -0,0 +1,88 @@
+#ifndef Book_builder_h_INCLUDED
+#define Book_builder_h_INCLUDED
+
+#include "Move.h"
+#include "Opening_book.h"
+#include "Pieces.h"
+#include "State.h"
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// turns PGN files into a Polyglot opening book
+namespace engine::book_builder
+{
+	enum class Result { white_win, black_win, draw, unknown };
+
+	struct Book_move
+	{
+		std::uint64_t key;
+		std::uint16_t move;
+		Side side;
+
+		constexpr bool operator==(const Book_move& other) const noexcept { return key==other.key && move==other.move; }
+	};
+
+	struct Book_move_hash
+	{
+		[[nodiscard]] std::size_t operator()(const Book_move& book_move) const noexcept { return book_move.key^(std::size_t{book_move.move}*0x9E3779B97F4A7C15ULL); }
+	};
+
+	struct Move_statistics
+	{
+		unsigned games{0}, wins{0}, draws{0};
+	};
+
+	using Statistics = std::unordered_map<Book_move, Move_statistics, Book_move_hash>;
+
+	// standard algebraic notation, nothing when the move is not legal or not unique
+	[[nodiscard]] std::optional<Move> parse_san(const State& state, std::string_view san) noexcept;
+
+	// about chunk_count pieces of text that each start where a game starts, so they can be parsed independently
+	[[nodiscard]] std::vector<std::string_view> split_into_chunks(const std::string_view text, const std::size_t chunk_count);
+
+	// counts the games, wins and draws of every move played in the first max_ply plies of a game
+	class Pgn_parser
+	{
+		public:
+
+		Pgn_parser(Statistics& statistics, const unsigned max_ply) : statistics_(statistics), max_ply_(max_ply)
+		{
+			game_moves_.reserve(max_ply);
+		}
+
+		void parse(const std::string_view text);
+
+		[[nodiscard]] inline std::size_t games() const noexcept { return games_; }
+
+		private:
+
+		[[nodiscard]] bool at_line_start() const noexcept { return index_==0 || text_[index_-1]=='\n'; }
+		void skip_line() noexcept;
+		[[nodiscard]] bool skip_to_game() noexcept;
+		void parse_tags(std::string_view& fen, Result& result) noexcept;
+		[[nodiscard]] std::string_view next_token() noexcept;
+		void parse_game();
+
+		Statistics& statistics_;
+		const unsigned max_ply_;
+		const State starting_state_{starting_fen};
+		std::vector<Book_move> game_moves_;
+		std::string_view text_;
+		std::size_t index_{0}, games_{0};
+	};
+
+	void merge(Statistics& total, const Statistics& statistics);
+
+	// sorted by key with the best moves of a position first, moves that never won or drew are left out
+	[[nodiscard]] std::vector<Opening_book::Entry> to_entries(const Statistics& statistics, const unsigned min_games);
+
+	void write_book(std::ostream& os, std::span<const Opening_book::Entry> entries);
+}
+
+#endif // Book_builder_h_INCLUDED
@@ -0,0 +1,194 @@
+#include <doctest/doctest.h>
+
+#include "Book_builder.h"
+#include "move_unmove.h"
+#include "Opening_book.h"
+#include "State.h"
+#include "Transposition_table.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+using namespace engine;
+
+namespace
+{
+	// comments, variations, annotations and move numbers in both styles, a game from a set up position and a game
+	// that loses every one of its moves
+	constexpr std::string_view pgn
+	{
+		"[Event \"a\"]\n"
+		"[Result \"1-0\"]\n"
+		"\n"
+		"1. e4 {the main line} e5 (1... c5 2. Nf3) 2. Nf3 $1 Nc6 1-0\n"
+		"\n"
+		"[Event \"b\"]\n"
+		"[Result \"0-1\"]\n"
+		"\n"
+		"1.d4 d5 2.c4 dxc4 0-1\n"
+		"\n"
+		"[Event \"c\"]\n"
+		"[Result \"1/2-1/2\"]\n"
+		"\n"
+		"1. e4 e5 2. Nf3 Nf6 1/2-1/2\n"
+		"\n"
+		"[Event \"d\"]\n"
+		"[FEN \"4k3/8/8/8/8/8/8/4K2R w K - 0 1\"]\n"
+		"[Result \"1-0\"]\n"
+		"\n"
+		"1. O-O Kd7 1-0\n"
+	};
+
+	[[nodiscard]] std::vector<std::tuple<std::uint64_t, std::uint16_t, std::uint16_t>> to_tuples(const std::vector<Opening_book::Entry>& entries)
+	{
+		std::vector<std::tuple<std::uint64_t, std::uint16_t, std::uint16_t>> tuples;
+		for(const auto& entry : entries)
+			tuples.emplace_back(entry.key, entry.move, entry.weight);
+		return tuples;
+	}
+
+	[[nodiscard]] State after(const std::string_view moves)
+	{
+		State state{starting_fen};
+		std::istringstream move_stream{std::string{moves}};
+		for(Move move; move_stream>>move;)
+			make(state, move);
+		return state;
+	}
+}
+
+TEST_SUITE("Book_builder.h")
+{
+	TEST_CASE("parse_san()")
+	{
+		const State start{starting_fen};
+		CHECK(book_builder::parse_san(start, "e4")==Move{algebraic_to_position("e2"), algebraic_to_position("e4")});
+		CHECK(book_builder::parse_san(start, "Nf3!?")==Move{algebraic_to_position("g1"), algebraic_to_position("f3")});
+		CHECK_FALSE(book_builder::parse_san(start, "e5"));
+		CHECK_FALSE(book_builder::parse_san(start, "Ke2"));
+		CHECK_FALSE(book_builder::parse_san(start, "O-O"));
+		CHECK_FALSE(book_builder::parse_san(start, "x"));
+
+		const State castling{"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1"};
+		CHECK(book_builder::parse_san(castling, "O-O")==Move{algebraic_to_position("e1"), algebraic_to_position("g1")});
+		CHECK(book_builder::parse_san(castling, "0-0-0")==Move{algebraic_to_position("e1"), algebraic_to_position("c1")});
+
+		// two knights and two rooks can reach the same square
+		const State disambiguation{"4k3/8/8/8/R7/8/8/1N2KN1R w - - 0 1"};
+		CHECK_FALSE(book_builder::parse_san(disambiguation, "Nd2"));
+		CHECK(book_builder::parse_san(disambiguation, "Nbd2")==Move{algebraic_to_position("b1"), algebraic_to_position("d2")});
+		CHECK(book_builder::parse_san(disambiguation, "Nfd2")==Move{algebraic_to_position("f1"), algebraic_to_position("d2")});
+		CHECK_FALSE(book_builder::parse_san(disambiguation, "Rh4"));
+		CHECK(book_builder::parse_san(disambiguation, "R1h4")==Move{algebraic_to_position("h1"), algebraic_to_position("h4")});
+		CHECK(book_builder::parse_san(disambiguation, "Rah4+")==Move{algebraic_to_position("a4"), algebraic_to_position("h4")});
+
+		const State promotion{"1n2k3/P7/8/8/8/8/8/4K3 w - - 0 1"};
+		CHECK(book_builder::parse_san(promotion, "a8=Q+")==Move{algebraic_to_position("a7"), algebraic_to_position("a8"), Piece::queen});
+		CHECK(book_builder::parse_san(promotion, "axb8N")==Move{algebraic_to_position("a7"), algebraic_to_position("b8"), Piece::knight});
+		CHECK_FALSE(book_builder::parse_san(promotion, "a8"));
+
+		const State en_passant{"4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1"};
+		CHECK(book_builder::parse_san(en_passant, "exd6")==Move{algebraic_to_position("e5"), algebraic_to_position("d6")});
+	}
+
+	TEST_CASE("split_into_chunks()")
+	{
+		book_builder::Statistics whole_statistics;
+		book_builder::Pgn_parser{whole_statistics, 20}.parse(pgn);
+		const auto whole_entries{to_tuples(book_builder::to_entries(whole_statistics, 1))};
+
+		for(std::size_t chunk_count{1}; chunk_count<=8; ++chunk_count)
+		{
+			CAPTURE(chunk_count);
+			const auto chunks{book_builder::split_into_chunks(pgn, chunk_count)};
+			REQUIRE_FALSE(chunks.empty());
+			CHECK(chunks.size()<=std::min<std::size_t>(chunk_count, 4));
+
+			// the chunks cover the text in order and each one starts a game
+			std::string joined_chunks;
+			for(const auto chunk : chunks)
+			{
+				CHECK(chunk.starts_with("[Event "));
+				joined_chunks+=chunk;
+			}
+			CHECK(joined_chunks==pgn);
+
+			// parsed apart and merged, the chunks give the same book as the whole text
+			book_builder::Statistics total;
+			std::size_t games{0};
+			for(const auto chunk : chunks)
+			{
+				book_builder::Statistics statistics;
+				book_builder::Pgn_parser parser{statistics, 20};
+				parser.parse(chunk);
+				games+=parser.games();
+				book_builder::merge(total, statistics);
+			}
+			CHECK(games==4);
+			CHECK(to_tuples(book_builder::to_entries(total, 1))==whole_entries);
+		}
+	}
+
+	TEST_CASE("to_entries()")
+	{
+		book_builder::Statistics statistics;
+		book_builder::Pgn_parser parser{statistics, 20};
+		parser.parse(pgn);
+		REQUIRE(parser.games()==4);
+
+		const auto entries{book_builder::to_entries(statistics, 1)};
+		CHECK(std::ranges::is_sorted(entries, {}, &Opening_book::Entry::key));
+		CHECK(std::ranges::none_of(entries, [](const Opening_book::Entry& entry){ return entry.weight==0; }));
+		// 1.e4 won once and drew once, the lost 1.d4 is left out
+		const std::uint64_t start_key{polyglot::hash(State{starting_fen})};
+		const auto start_entries{std::ranges::count(entries, start_key, &Opening_book::Entry::key)};
+		CHECK(start_entries==1);
+
+		SUBCASE("scores too large for 16 bits are scaled without rounding to nothing")
+		{
+			book_builder::Statistics many_games;
+			const book_builder::Book_move popular{start_key, 1, Side::white}, rare{start_key, 2, Side::white};
+			many_games[popular]={.games=100000, .wins=100000, .draws=0};
+			many_games[rare]={.games=1, .wins=0, .draws=1};
+			const auto scaled_entries{book_builder::to_entries(many_games, 1)};
+			REQUIRE(scaled_entries.size()==2);
+			CHECK(scaled_entries[0].move==1);
+			CHECK(scaled_entries[0].weight==65535);
+			CHECK(scaled_entries[1].weight==1);
+		}
+
+		SUBCASE("the book is probed like any other")
+		{
+			const std::filesystem::path path{std::filesystem::temp_directory_path()/"book_builder_test.bin"};
+			{
+				std::ofstream book{path, std::ios::binary};
+				book_builder::write_book(book, entries);
+			}
+			Opening_book opening_book;
+			REQUIRE(opening_book.open(path));
+
+			// the only book move of each position is always the one picked
+			CHECK(opening_book.probe(State{starting_fen})==Move{algebraic_to_position("e2"), algebraic_to_position("e4")});
+			CHECK(opening_book.probe(after("e2e4"))==Move{algebraic_to_position("e7"), algebraic_to_position("e5")});
+			CHECK(opening_book.probe(after("d2d4"))==Move{algebraic_to_position("d7"), algebraic_to_position("d5")});
+			CHECK(opening_book.probe(after("e2e4 e7e5 g1f3"))==Move{algebraic_to_position("g8"), algebraic_to_position("f6")});
+			CHECK(opening_book.probe(State{"4k3/8/8/8/8/8/8/4K2R w K - 0 1"})==Move{algebraic_to_position("e1"), algebraic_to_position("g1")});
+			// the variation is not part of the game
+			CHECK_FALSE(opening_book.probe(after("e2e4 c7c5")));
+
+			std::filesystem::remove(path);
+		}
+
+		SUBCASE("moves played less often than min_games are left out")
+		{
+			const auto frequent_entries{book_builder::to_entries(statistics, 2)};
+			CHECK(frequent_entries.size()==3);
+		}
+	}
+}
@@ -19,7 +19,7 @@ namespace engine
 	template <typename Mapped_type>
 	using Side_map = Enum_map_from_size<Side, Mapped_type>;
 
-	constexpr auto all_sides={Side::white, Side::black};
+	inline constexpr std::array all_sides{Side::white, Side::black};
 
 	inline Side other_side(const Side& side) noexcept
 	{
@@ -40,10 +40,13 @@ namespace engine
 	max_legal_moves{218},
 	max_depth{64},
 	king_max_adjacent_squares{6},
+	default_multipv{1},
 	default_threads{1 /*std::max(unsigned{4}, std::thread::hardware_concurrency())*/};
 
 	constexpr unsigned default_table_size{64};
 
+	constexpr std::size_t cache_line_size{64};
+
 	constexpr std::string_view name{"cpp_engine"}, author{"Michael Lim"}, starting_fen{"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"};
 
 	constexpr std::uint64_t file_a{0x101010101010101}, file_h{0x8080808080808080}, rank_one{0xff};
@@ -60,6 +63,7 @@ namespace uci
 {
 	constexpr unsigned max_table_size{33554432};
 	constexpr std::chrono::milliseconds max_move_overhead{5000};
+	constexpr unsigned max_multipv{engine::max_legal_moves};
 } // namespace uci
 
 #endif // Constants_h_INCLUDED
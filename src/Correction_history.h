@@ -0,0 +1,68 @@
+#ifndef Correction_history_h_INCLUDED
+#define Correction_history_h_INCLUDED
+
+#include "Constants.h"
+#include "State.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace engine
+{
+	// learns how far the static evaluation misses the search result in similar pawn structures and material balances,
+	// each search thread owns one so it is never shared
+	class Correction_history
+	{
+		public:
+
+		constexpr static std::size_t size{16384};
+		// entries keep this many fractions of an evaluation unit so small differences still accumulate
+		constexpr static int grain{256};
+		constexpr static int max_correction{64*16};
+
+		[[nodiscard]] int correction(const State& state) const noexcept
+		{
+			const auto& [pawn_entry, material_entry]{entries(state)};
+			return (pawn_entry+material_entry)/(2*grain);
+		}
+
+		// deeper results are trusted more, the difference is search result minus static evaluation
+		void update(const State& state, const unsigned depth, const int difference) noexcept
+		{
+			constexpr int weight_scale{256}, max_weight{16};
+			const int weight{std::min<int>(depth+1, max_weight)};
+			const int target{std::clamp(difference, -max_correction, max_correction)*grain};
+			const auto& [pawn_index, material_index]{indexes(state)};
+			for(std::int32_t* entry : {&pawn_entries_[state.side_to_move][pawn_index], &material_entries_[state.side_to_move][material_index]})
+				*entry=(*entry*(weight_scale-weight)+target*weight)/weight_scale;
+		}
+
+		void clear() noexcept
+		{
+			for(auto& side_entries : pawn_entries_)
+				side_entries.fill(0);
+			for(auto& side_entries : material_entries_)
+				side_entries.fill(0);
+		}
+
+		private:
+
+		[[nodiscard]] std::pair<std::size_t, std::size_t> indexes(const State& state) const noexcept
+		{
+			return {state.pawn_hash%size, state.material_hash%size};
+		}
+
+		[[nodiscard]] std::pair<std::int32_t, std::int32_t> entries(const State& state) const noexcept
+		{
+			const auto& [pawn_index, material_index]{indexes(state)};
+			return {pawn_entries_[state.side_to_move][pawn_index], material_entries_[state.side_to_move][material_index]};
+		}
+
+		Side_map<std::array<std::int32_t, size>> pawn_entries_{};
+		Side_map<std::array<std::int32_t, size>> material_entries_{};
+	};
+}
+
+#endif // Correction_history_h_INCLUDED
@@ -0,0 +1,42 @@
+#include <doctest/doctest.h>
+
+#include "Correction_history.h"
+#include "State.h"
+
+#include <memory>
+
+using namespace engine;
+
+TEST_SUITE("Correction_history.h")
+{
+	TEST_CASE("Correction_history")
+	{
+		const auto correction_history{std::make_unique<Correction_history>()};
+		const State state{starting_fen}, other_pawns{"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1"};
+		REQUIRE(correction_history->correction(state)==0);
+
+		SUBCASE("moves towards the search result")
+		{
+			for(int i{0}; i<100; ++i)
+				correction_history->update(state, 10, 400);
+			CHECK(correction_history->correction(state)>300);
+			CHECK(correction_history->correction(state)<=400);
+			// only the side to move and the keys of the position are affected
+			CHECK(correction_history->correction(other_pawns)==0);
+		}
+
+		SUBCASE("is bounded")
+		{
+			for(int i{0}; i<100; ++i)
+				correction_history->update(state, 10, -100000);
+			CHECK(correction_history->correction(state)>=-Correction_history::max_correction);
+		}
+
+		SUBCASE("clear()")
+		{
+			correction_history->update(state, 10, 400);
+			correction_history->clear();
+			CHECK(correction_history->correction(state)==0);
+		}
+	}
+}
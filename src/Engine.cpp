@@ -2,28 +2,72 @@
 
 #include <expected>
 #include <future>
+#include <stdexcept>
 #include <thread>
 
 namespace engine
 {
+	Neural_network Engine::startup_network()
+	{
+		auto neural_network{Neural_network::load_default()};
+		if(!neural_network)
+			throw std::runtime_error{neural_network.error()};
+		return std::move(*neural_network);
+	}
+
+	std::expected<void, std::string> Engine::load_network(const std::filesystem::path& path) noexcept
+	{
+		auto loaded{path.empty()? Neural_network::load_default() : Neural_network::load_from_file(path)};
+		if(!loaded)
+			return std::unexpected{loaded.error()};
+		neural_network=std::move(*loaded);
+		// scores and corrections learned with the old net do not carry over
+		clear_tt();
+		clear_correction_histories();
+		return {};
+	}
+
 	std::expected<Search_results, search_stopped> Engine::generate_best_move(std::atomic<bool>& should_stop_searching, const Search_options& search_options) noexcept
 	{
 		using return_type=std::expected<Search_results, search_stopped>;
-		std::atomic<bool> found_result{false};
+
+		// analysis keeps searching until it is stopped, so it never plays from the book
+		if(search_options.searchmoves.empty() && !search_options.infinite && !search_options.mate)
+		{
+			if(const auto book_move{opening_book_.probe(state_)})
+			{
+				Search_results book_results{};
+				book_results.pv.push_back(*book_move);
+				return book_results;
+			}
+		}
+
+		transposition_table_.new_search();
+		std::vector<Node_counter> node_counters(search_options.threads), tbhit_counters(search_options.threads);
+		// histories outlive a search so each thread keeps what it learned, resizing keeps the existing ones
+		correction_histories_.resize(search_options.threads);
 		std::promise<return_type> shared_promise;
 		std::future<return_type> future_return_value{shared_promise.get_future()};
 		std::vector<std::jthread> threads;
 		const auto task=[&](const int thread_id)
 		{
-			const auto return_value{iterative_deepening(should_stop_searching, search_options, state_, transposition_table_, neural_network, thread_id)};
-			if(!found_result.exchange(true))
+			const auto return_value{iterative_deepening(should_stop_searching, node_counters, tbhit_counters, correction_histories_, search_options, state_, transposition_table_, neural_network, tablebases_, thread_id)};
+			// helpers stop on their own, e.g. at once with a single legal move, the main thread reports the search and ends it
+			if(thread_id==main_thread_id)
+			{
 				shared_promise.set_value(return_value);
-			should_stop_searching=true;
+				should_stop_searching=true;
+			}
 		};
 
-		for(int i{0}, extra_threads=search_options.threads-1; i<extra_threads; ++i)
-			threads.emplace_back(task, i+1);
-		task(search_options.threads);
-		return future_return_value.get();
+		for(int thread_id{main_thread_id+1}; thread_id<search_options.threads; ++thread_id)
+			threads.emplace_back(task, thread_id);
+		task(main_thread_id);
+
+		auto search_results{future_return_value.get()};
+		threads.clear();
+		if(search_results)
+			search_results->nodes=total_nodes(node_counters);
+		return search_results;
 	}
 } // namespace engine
@@ -2,12 +2,18 @@
 #define Engine_h_INCLUDED
 
 #include "Constants.h"
+#include "Correction_history.h"
 #include "nnue/Neural_network.h"
+#include "Opening_book.h"
 #include "search.h"
 #include "State.h"
+#include "Syzygy.h"
 #include "Transposition_table.h"
 
 #include <expected>
+#include <filesystem>
+#include <string>
+#include <vector>
 
 namespace engine
 {
@@ -20,6 +26,12 @@ namespace engine
 			transposition_table_.clear();
 		}
 
+		inline void clear_correction_histories() noexcept
+		{
+			for(auto& correction_history : correction_histories_)
+				correction_history.clear();
+		}
+
 		inline void set_state(const State& state) noexcept
 		{
 			state_=state;
@@ -30,14 +42,33 @@ namespace engine
 			transposition_table_.resize(size_mb);
 		}
 
+		inline std::size_t load_tablebases(const std::string_view paths) noexcept
+		{
+			return tablebases_.load(paths);
+		}
+
+		inline bool open_book(const std::filesystem::path& path) noexcept
+		{
+			return opening_book_.open(path);
+		}
+
+		// an empty path goes back to the default net, a rejected net leaves the current one in place
+		std::expected<void, std::string> load_network(const std::filesystem::path& path) noexcept;
+
 		[[nodiscard]] std::expected<Search_results, search_stopped> generate_best_move(std::atomic<bool>& should_stop_searching, const Search_options& search_options) noexcept;
 
-		Neural_network neural_network{"/home/michael/coding/projects/ChessEngine/src/nnue/nn-97f742aaefcd.nnue"};
+		Neural_network neural_network{startup_network()};
 
 		private:
 
+		// throws when there is no default net, the engine cannot evaluate without one
+		[[nodiscard]] static Neural_network startup_network();
+
 		State state_{starting_fen};
 		Transposition_table transposition_table_{default_table_size};
+		syzygy::Tablebases tablebases_;
+		Opening_book opening_book_;
+		std::vector<Correction_history> correction_histories_;
 	};
 }
 
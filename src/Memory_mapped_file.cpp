@@ -0,0 +1,93 @@
+#include "Memory_mapped_file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace engine
+{
+	std::optional<Memory_mapped_file> Memory_mapped_file::open(const std::filesystem::path& path) noexcept
+	{
+#ifdef _WIN32
+		const HANDLE file{CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr)};
+		if(file==INVALID_HANDLE_VALUE)
+			return std::nullopt;
+		LARGE_INTEGER size;
+		if(!GetFileSizeEx(file, &size) || size.QuadPart==0)
+		{
+			CloseHandle(file);
+			return std::nullopt;
+		}
+		const HANDLE mapping{CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr)};
+		CloseHandle(file);
+		if(!mapping)
+			return std::nullopt;
+		void* const data{MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)};
+		// the view keeps the mapping alive
+		CloseHandle(mapping);
+		if(!data)
+			return std::nullopt;
+		return Memory_mapped_file{static_cast<const std::uint8_t*>(data), static_cast<std::size_t>(size.QuadPart)};
+#else
+		const int file{::open(path.c_str(), O_RDONLY)};
+		if(file==-1)
+			return std::nullopt;
+		struct stat file_status;
+		if(fstat(file, &file_status)==-1 || file_status.st_size==0)
+		{
+			close(file);
+			return std::nullopt;
+		}
+		void* const data{mmap(nullptr, file_status.st_size, PROT_READ, MAP_SHARED, file, 0)};
+		// the mapping keeps the file alive
+		close(file);
+		if(data==MAP_FAILED)
+			return std::nullopt;
+		return Memory_mapped_file{static_cast<const std::uint8_t*>(data), static_cast<std::size_t>(file_status.st_size)};
+#endif
+	}
+
+	Memory_mapped_file::Memory_mapped_file(Memory_mapped_file&& other) noexcept
+		: data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0))
+	{
+	}
+
+	Memory_mapped_file& Memory_mapped_file::operator=(Memory_mapped_file&& other) noexcept
+	{
+		if(this!=&other)
+		{
+			unmap();
+			data_=std::exchange(other.data_, nullptr);
+			size_=std::exchange(other.size_, 0);
+		}
+		return *this;
+	}
+
+	Memory_mapped_file::~Memory_mapped_file()
+	{
+		unmap();
+	}
+
+	void Memory_mapped_file::unmap() noexcept
+	{
+		if(!data_)
+			return;
+#ifdef _WIN32
+		UnmapViewOfFile(data_);
+#else
+		munmap(const_cast<std::uint8_t*>(data_), size_);
+#endif
+		data_=nullptr;
+		size_=0;
+	}
+}
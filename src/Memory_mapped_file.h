@@ -0,0 +1,37 @@
+#ifndef Memory_mapped_file_h_INCLUDED
+#define Memory_mapped_file_h_INCLUDED
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+namespace engine
+{
+	// read only view of a whole file, the operating system pages it in on demand
+	class Memory_mapped_file
+	{
+		public:
+
+		[[nodiscard]] static std::optional<Memory_mapped_file> open(const std::filesystem::path& path) noexcept;
+
+		Memory_mapped_file(const Memory_mapped_file&) = delete;
+		Memory_mapped_file& operator=(const Memory_mapped_file&) = delete;
+		Memory_mapped_file(Memory_mapped_file&& other) noexcept;
+		Memory_mapped_file& operator=(Memory_mapped_file&& other) noexcept;
+		~Memory_mapped_file();
+
+		[[nodiscard]] inline std::span<const std::uint8_t> bytes() const noexcept { return {data_, size_}; }
+
+		private:
+
+		Memory_mapped_file(const std::uint8_t* data, const std::size_t size) noexcept : data_(data), size_(size) {}
+
+		void unmap() noexcept;
+
+		const std::uint8_t* data_{nullptr};
+		std::size_t size_{0};
+	};
+}
+
+#endif // Memory_mapped_file_h_INCLUDED
@@ -1,4 +1,5 @@
 #include "Bitboard.h"
+#include "Chess_data.h"
 #include "Constants.h"
 #include "Enum_map.h"
 #include "Fixed_capacity_vector.h"
@@ -8,6 +9,7 @@
 #include "Position.h"
 #include "State.h"
 
+#include <algorithm>
 #include <array>
 #include <functional>
 #include <optional>
@@ -254,6 +256,24 @@ namespace
 			pinned_pieces|=generate_pins_from(attacking_rook_likes, rook_legal_moves_bb);
 		return pinned_pieces;
 	}
+
+	[[nodiscard]] Bitboard attackers_to(const State& state, const Position& square, const Bitboard& occupied_squares) noexcept
+	{
+		const Bitboard square_bb{Bitboard::onebit(square)};
+		// a pawn attacks the square if a pawn of the other colour on the square would attack it back
+		const Bitboard white_pawn_attackers{((square_bb & ~Bitboard{file_a}) >> (board_size+1)) | ((square_bb & ~Bitboard{file_h}) >> (board_size-1))},
+					   black_pawn_attackers{((square_bb & ~Bitboard{file_a}) << (board_size-1)) | ((square_bb & ~Bitboard{file_h}) << (board_size+1))};
+		const auto& white_pieces{state.sides[Side::white].pieces};
+		const auto& black_pieces{state.sides[Side::black].pieces};
+		const auto both_sides{[&](const Piece piece){ return white_pieces[piece] | black_pieces[piece]; }};
+
+		Bitboard attackers{(white_pawn_attackers & white_pieces[Piece::pawn]) | (black_pawn_attackers & black_pieces[Piece::pawn])};
+		attackers |= knight_mask[to_index(square)] & both_sides(Piece::knight);
+		attackers |= king_mask[to_index(square)] & both_sides(Piece::king);
+		attackers |= bishop_legal_moves_bb(square, occupied_squares) & (both_sides(Piece::bishop) | both_sides(Piece::queen));
+		attackers |= rook_legal_moves_bb(square, occupied_squares) & (both_sides(Piece::rook) | both_sides(Piece::queen));
+		return attackers & occupied_squares;
+	}
 }
 
 namespace engine
@@ -308,8 +328,13 @@ namespace engine
 			else
 				valid_moves|=intersection(bishop_legal_moves_bb, checking_piece_square, king_square);
 		}
+		// a pawn that checks right after its double move can also be taken en passant, behind its square
+		Bitboard valid_pawn_moves{valid_moves};
+		if(const auto& en_passant_square=state.en_passant_target_square; en_passant_square && attacking_pawns_popcount==1
+			&& to_index(checking_pieces.lsb_square())==to_index(*en_passant_square)+(state.side_to_move==Side::white? -board_size : board_size))
+			valid_pawn_moves|=Bitboard::onebit(*en_passant_square);
 		const Bitboard pinned_pieces = generate_pinned_pieces(state, king_square);
-		pawn_moves<moves_type>(legal_moves, pieces[Piece::pawn], occupied_squares, state.side_to_move, our_occupied_squares, state.en_passant_target_square, valid_moves, enemy_side.pieces[Piece::rook] | enemy_side.pieces[Piece::queen], king_square, pinned_pieces);
+		pawn_moves<moves_type>(legal_moves, pieces[Piece::pawn], occupied_squares, state.side_to_move, our_occupied_squares, state.en_passant_target_square, valid_pawn_moves, enemy_side.pieces[Piece::rook] | enemy_side.pieces[Piece::queen], king_square, pinned_pieces);
 		knight_moves<moves_type>(legal_moves, pieces[Piece::knight] & ~pinned_pieces, our_occupied_squares, valid_moves, enemy_occupied_squares);
 
 		bishop_moves<moves_type>(legal_moves, pieces[Piece::bishop], occupied_squares, our_occupied_squares, king_square,valid_moves, pinned_pieces, enemy_occupied_squares);
@@ -346,4 +371,95 @@ namespace engine
 		});
 		return attack_map;
 	}
+
+	// swap algorithm, each side recaptures with its least valuable attacker and may stop when that loses material
+	int static_exchange_evaluation(const State& state, const Move& move) noexcept
+	{
+		const auto exchange_value=[](const Piece piece)
+		{
+			return piece==Piece::king? chess_data::piece_values[Piece::queen]*2 : chess_data::piece_values[piece];
+		};
+		const Position origin_square{move.from_square()}, destination_square{move.destination_square()};
+		Piece attacker{state.piece_at(origin_square, state.side_to_move).value()};
+		const bool is_en_passant{attacker==Piece::pawn && state.en_passant_target_square==destination_square};
+		const std::optional<Piece> captured_piece{is_en_passant? Piece::pawn : state.piece_at(destination_square, other_side(state.side_to_move))};
+
+		std::array<int, 32> gains{};
+		gains[0]=captured_piece? exchange_value(*captured_piece) : 0;
+		Bitboard occupied_squares{state.occupied_squares()};
+		occupied_squares.remove_piece(origin_square);
+		if(is_en_passant)
+			occupied_squares.remove_piece(Position{origin_square.rank_, destination_square.file_});
+
+		std::size_t depth{0};
+		for(Side side{other_side(state.side_to_move)}; depth+1<gains.size(); side=other_side(side))
+		{
+			const Bitboard side_attackers{attackers_to(state, destination_square, occupied_squares) & state.sides[side].occupied_squares()};
+			if(side_attackers.is_empty())
+				break;
+
+			Piece next_attacker{Piece::king};
+			for(const Piece piece : {Piece::pawn, Piece::knight, Piece::bishop, Piece::rook, Piece::queen})
+			{
+				if(!(side_attackers & state.sides[side].pieces[piece]).is_empty())
+				{
+					next_attacker=piece;
+					break;
+				}
+			}
+
+			++depth;
+			gains[depth]=exchange_value(attacker)-gains[depth-1];
+			if(std::max(-gains[depth-1], gains[depth])<0)
+				break;
+
+			occupied_squares.remove_piece((side_attackers & state.sides[side].pieces[next_attacker]).lsb_square());
+			attacker=next_attacker;
+		}
+		for(; depth>0; --depth)
+			gains[depth-1]=-std::max(-gains[depth-1], gains[depth]);
+		return gains[0];
+	}
+
+	// direct and discovered checks, including the rook of a castling move and a pawn captured en passant uncovering
+	// a slider
+	bool gives_check(const State& state, const Move& move) noexcept
+	{
+		const auto& pieces = state.sides[state.side_to_move].pieces;
+		const Position origin_square{move.from_square()}, destination_square{move.destination_square()};
+		const Position enemy_king_square{state.sides[other_side(state.side_to_move)].pieces[Piece::king].lsb_square()};
+		const Piece moved_piece{move.is_promotion()? move.promotion_piece() : state.piece_at(origin_square, state.side_to_move).value()};
+
+		Bitboard occupied_squares{state.occupied_squares()};
+		occupied_squares.remove_piece(origin_square);
+		occupied_squares.add_piece(destination_square);
+		Bitboard bishop_likes{(pieces[Piece::bishop] | pieces[Piece::queen]) & ~Bitboard::onebit(origin_square)},
+				 rook_likes{(pieces[Piece::rook] | pieces[Piece::queen]) & ~Bitboard::onebit(origin_square)};
+		if(moved_piece==Piece::bishop || moved_piece==Piece::queen)
+			bishop_likes.add_piece(destination_square);
+		if(moved_piece==Piece::rook || moved_piece==Piece::queen)
+			rook_likes.add_piece(destination_square);
+		if(moved_piece==Piece::king && std::abs(destination_square.file_-origin_square.file_)==2)
+		{
+			const bool is_kingside{destination_square.file_>origin_square.file_};
+			const Position rook_origin{origin_square.rank_, is_kingside? 7 : 0}, rook_destination{origin_square.rank_, is_kingside? 5 : 3};
+			occupied_squares.remove_piece(rook_origin);
+			occupied_squares.add_piece(rook_destination);
+			rook_likes.remove_piece(rook_origin);
+			rook_likes.add_piece(rook_destination);
+		}
+		if(moved_piece==Piece::pawn && state.en_passant_target_square==destination_square)
+			occupied_squares.remove_piece(Position{origin_square.rank_, destination_square.file_});
+
+		if(!(bishop_legal_moves_bb(enemy_king_square, occupied_squares) & bishop_likes).is_empty() || !(rook_legal_moves_bb(enemy_king_square, occupied_squares) & rook_likes).is_empty())
+			return true;
+		if(moved_piece==Piece::knight)
+			return knight_mask[to_index(destination_square)].is_occupied(enemy_king_square);
+		if(moved_piece==Piece::pawn)
+		{
+			const auto pawn_direction{state.side_to_move == Side::white? 1 : -1};
+			return destination_square.rank_+pawn_direction==enemy_king_square.rank_ && std::abs(destination_square.file_-enemy_king_square.file_)==1;
+		}
+		return false;
+	}
 }
@@ -18,6 +18,8 @@ namespace engine
 	extern template Fixed_capacity_vector<Move, max_legal_moves> generate_moves<Moves_type::noisy>(const State& state) noexcept;
 	
 	[[nodiscard]] Bitboard generate_attack_map(const State& state) noexcept;
+	[[nodiscard]] bool gives_check(const State& state, const Move& move) noexcept;
+	[[nodiscard]] int static_exchange_evaluation(const State& state, const Move& move) noexcept;
 }
 
 #endif // Move_generator_h_INCLUDED
@@ -2,7 +2,9 @@
 
 #include <string_view>
 
+#include "Chess_data.h"
 #include "Move_generator.h"
+#include "move_unmove.h"
 
 using namespace engine;
 
@@ -19,10 +21,10 @@ using namespace engine;
 		}
 		else
 		{
-			state.make(move);
+			make(state, move);
 			current_count = depth == 2? generate_moves<Moves_type::legal>(state).size() : perft(depth-1, state, false);
 			nodes += current_count;
-			state.unmove();
+			unmove(state);
 		}
 	}
 	return nodes;
@@ -55,4 +57,61 @@ TEST_SUITE("Move Generator")
 			CHECK(perft(5, state) == test.expected_nodes);
 		}
 	}
+
+	TEST_CASE("gives_check()")
+	{
+		// castling checks with the rook and en passant captures uncovering a rook or bishop, the other positions
+		// add direct and discovered checks of every kind
+		constexpr std::array<std::string_view, 4> check_fens
+		{{
+			"5k2/8/8/8/8/8/8/R3K2R w KQ - 0 1",
+			"3k4/8/8/8/8/8/8/R3K2R w KQ - 0 1",
+			"8/8/8/R2pP2k/8/8/8/K7 w - d6 0 1",
+			"6k1/8/8/3pP3/8/8/B7/7K w - d6 0 1"
+		}};
+		const auto check_moves = [](State& state)
+		{
+			for(const auto& move : generate_moves<Moves_type::legal>(state))
+			{
+				CAPTURE(move);
+				const bool expected{gives_check(state, move)};
+				make(state, move);
+				CHECK(state.in_check()==expected);
+				unmove(state);
+			}
+		};
+		for(const auto fen : check_fens)
+		{
+			State state{fen};
+			CAPTURE(std::string{fen});
+			check_moves(state);
+		}
+		CHECK(gives_check(State{check_fens[0]}, Move{algebraic_to_position("e1"), algebraic_to_position("g1")}));
+		CHECK(gives_check(State{check_fens[1]}, Move{algebraic_to_position("e1"), algebraic_to_position("c1")}));
+		CHECK(gives_check(State{check_fens[3]}, Move{algebraic_to_position("e5"), algebraic_to_position("d6")}));
+
+		for(const auto& test : tests)
+		{
+			State state{test.fen};
+			CAPTURE(std::string{test.name});
+			for(const auto& move : generate_moves<Moves_type::legal>(state))
+			{
+				make(state, move);
+				check_moves(state);
+				unmove(state);
+			}
+		}
+	}
+
+	TEST_CASE("static_exchange_evaluation")
+	{
+		const State undefended{"1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1"};
+		CHECK(static_exchange_evaluation(undefended, Move{algebraic_to_position("e1"), algebraic_to_position("e5")})==chess_data::piece_values[Piece::pawn]);
+
+		const State defended{"4k3/8/3p4/4p3/8/8/8/4RK2 w - - 0 1"};
+		CHECK(static_exchange_evaluation(defended, Move{algebraic_to_position("e1"), algebraic_to_position("e5")})==chess_data::piece_values[Piece::pawn]-chess_data::piece_values[Piece::rook]);
+
+		const State quiet{starting_fen};
+		CHECK(static_exchange_evaluation(quiet, Move{algebraic_to_position("e2"), algebraic_to_position("e4")})==0);
+	}
 }
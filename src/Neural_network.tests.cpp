@@ -0,0 +1,130 @@
+#include <doctest/doctest.h>
+
+#include "Move_generator.h"
+#include "move_unmove.h"
+#include "nnue/Accumulator.h"
+#include "nnue/Embedded_network.h"
+#include "nnue/Neural_network.h"
+#include "State.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <vector>
+
+using namespace engine;
+
+namespace
+{
+	// the bytes of the default net, empty when there is none
+	[[nodiscard]] std::vector<std::uint8_t> default_net_bytes()
+	{
+		if(!embedded_network().empty())
+			return {embedded_network().begin(), embedded_network().end()};
+		std::ifstream net_file{std::filesystem::path{Neural_network::default_file_name}, std::ios::binary};
+		return {std::istreambuf_iterator<char>{net_file}, std::istreambuf_iterator<char>{}};
+	}
+}
+
+TEST_SUITE("Neural_network.h")
+{
+	TEST_CASE("a batch evaluates like its positions one by one")
+	{
+		// CMake fetches the default net, without it there is nothing to test
+		const auto neural_network{Neural_network::load_default()};
+		if(!neural_network)
+		{
+			MESSAGE(neural_network.error());
+			return;
+		}
+
+		// positions along a game, 37 fills one group of max_batch_size and leaves 5, neither a multiple of the 4
+		// positions the dense layers take together
+		constexpr std::size_t number_of_positions{37};
+		State state{starting_fen};
+		std::vector<Accumulator> accumulators;
+		accumulators.reserve(number_of_positions);
+		std::vector<Neural_network::Batch_entry> batch;
+		std::vector<int> expected_evaluations;
+		for(std::size_t index{0}; index<number_of_positions; ++index)
+		{
+			accumulators.push_back(fresh_accumulator(state, *neural_network));
+			const std::size_t number_of_pieces{state.occupied_squares().popcount()};
+			batch.push_back({state.side_to_move, number_of_pieces, &accumulators.back()});
+			expected_evaluations.push_back(neural_network->evaluate(state.side_to_move, number_of_pieces, accumulators.back()));
+			auto moves{generate_moves<Moves_type::legal>(state)};
+			REQUIRE_FALSE(moves.empty());
+			make(state, moves[index*7%moves.size()]);
+		}
+
+		for(const std::size_t size : {1uz, 3uz, 5uz, 31uz, 33uz, number_of_positions})
+		{
+			CAPTURE(size);
+			std::vector<int> evaluations(size);
+			neural_network->evaluate(std::span{batch}.first(size), evaluations);
+			CHECK(std::ranges::equal(evaluations, std::span{expected_evaluations}.first(size)));
+		}
+	}
+
+	TEST_CASE("load_from_memory() rejects corrupted nets")
+	{
+		const std::vector<std::uint8_t> net_bytes{default_net_bytes()};
+		if(net_bytes.empty())
+		{
+			MESSAGE("no default net to corrupt");
+			return;
+		}
+		REQUIRE(Neural_network::load_from_memory(net_bytes, "net").has_value());
+
+		// the header holds the version, the hash and the description's length, the feature transformer's hash follows
+		// the description
+		constexpr std::size_t version_offset{0}, hash_offset{4}, description_size_offset{8}, description_offset{12};
+		std::uint32_t description_size{0};
+		for(std::size_t index{0}; index<sizeof(description_size); ++index)
+			description_size|=std::uint32_t{net_bytes[description_size_offset+index]}<<(8*index);
+		const std::size_t feature_transformer_hash_offset{description_offset+description_size};
+
+		std::vector<std::uint8_t> corrupted_bytes{net_bytes};
+		const auto rejection=[&]
+		{
+			const auto neural_network{Neural_network::load_from_memory(corrupted_bytes, "net")};
+			REQUIRE_FALSE(neural_network.has_value());
+			return neural_network.error();
+		};
+
+		SUBCASE("wrong version")
+		{
+			corrupted_bytes[version_offset]^=1;
+			CHECK(rejection().contains("version"));
+		}
+		SUBCASE("truncated")
+		{
+			corrupted_bytes.pop_back();
+			CHECK(rejection().contains("size"));
+		}
+		SUBCASE("trailing bytes")
+		{
+			corrupted_bytes.push_back(0);
+			CHECK(rejection().contains("size"));
+		}
+		SUBCASE("header hash")
+		{
+			corrupted_bytes[hash_offset]^=1;
+			CHECK(rejection().contains("hash"));
+		}
+		SUBCASE("layer hash")
+		{
+			REQUIRE(feature_transformer_hash_offset<corrupted_bytes.size());
+			corrupted_bytes[feature_transformer_hash_offset]^=1;
+			CHECK(rejection().contains("hash"));
+		}
+		SUBCASE("empty")
+		{
+			corrupted_bytes.clear();
+			CHECK_FALSE(Neural_network::load_from_memory(corrupted_bytes, "net").has_value());
+		}
+	}
+}
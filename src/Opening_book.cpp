@@ -0,0 +1,109 @@
+#include "Opening_book.h"
+
+#include "Move_generator.h"
+#include "Transposition_table.h"
+
+#include <algorithm>
+#include <ranges>
+#include <vector>
+
+namespace engine
+{
+	namespace
+	{
+		[[nodiscard]] std::uint64_t read_big_endian(const std::uint8_t* data, const std::size_t size) noexcept
+		{
+			std::uint64_t value{0};
+			for(std::size_t i{0}; i<size; ++i)
+				value=(value<<8) | data[i];
+			return value;
+		}
+
+		// promotion pieces are numbered knight=1 to queen=4 in the book format
+		constexpr std::array<Piece, 5> polyglot_promotion_pieces{Piece::pawn, Piece::knight, Piece::bishop, Piece::rook, Piece::queen};
+	}
+
+	bool Opening_book::open(const std::filesystem::path& path) noexcept
+	{
+		file_.reset();
+		if(path.empty())
+			return false;
+		file_=Memory_mapped_file::open(path);
+		if(file_ && file_->bytes().size()%entry_size!=0)
+			file_.reset();
+		return file_.has_value();
+	}
+
+	Opening_book::Entry Opening_book::entry(const std::size_t index) const noexcept
+	{
+		const std::uint8_t* data{file_->bytes().data()+index*entry_size};
+		return Entry
+		{
+			.key=read_big_endian(data, 8),
+			.move=static_cast<std::uint16_t>(read_big_endian(data+8, 2)),
+			.weight=static_cast<std::uint16_t>(read_big_endian(data+10, 2)),
+			.learn=static_cast<std::uint32_t>(read_big_endian(data+12, 4))
+		};
+	}
+
+	std::optional<Move> Opening_book::probe(const State& state) noexcept
+	{
+		if(!file_)
+			return std::nullopt;
+
+		const std::uint64_t key{polyglot::hash(state)};
+		const auto indexes{std::views::iota(std::size_t{0}, size())};
+		const auto first{std::ranges::partition_point(indexes, [&](const std::size_t index){ return entry(index).key<key; })};
+
+		const auto legal_moves{generate_moves<Moves_type::legal>(state)};
+		std::vector<Move> moves;
+		std::vector<std::uint16_t> weights;
+		for(std::size_t index{*first}; index<size() && entry(index).key==key; ++index)
+		{
+			const Entry book_entry{entry(index)};
+			const Move move{from_polyglot_move(state, book_entry.move)};
+			// a key collision can suggest a move that is illegal here
+			if(std::ranges::find(legal_moves, move)==legal_moves.end())
+				continue;
+			moves.push_back(move);
+			weights.push_back(book_entry.weight);
+		}
+
+		if(moves.empty())
+			return std::nullopt;
+		if(std::ranges::all_of(weights, [](const std::uint16_t weight){ return weight==0; }))
+			std::ranges::fill(weights, 1);
+		std::discrete_distribution<std::size_t> distribution(weights.begin(), weights.end());
+		return moves[distribution(random_engine_)];
+	}
+
+	std::uint16_t Opening_book::to_polyglot_move(const State& state, const Move& move) noexcept
+	{
+		Position destination{move.destination_square()};
+		const Position from{move.from_square()};
+		// castling is stored as the king capturing its own rook
+		const bool is_castling{state.sides[state.side_to_move].pieces[Piece::king].is_occupied(from) && std::abs(destination.file_-from.file_)>1};
+		if(is_castling)
+			destination.file_=destination.file_>from.file_? 7 : 0;
+
+		std::uint16_t polyglot_move=destination.file_ | (destination.rank_<<3) | (from.file_<<6) | (from.rank_<<9);
+		if(move.is_promotion())
+			polyglot_move|=static_cast<std::uint16_t>(std::ranges::find(polyglot_promotion_pieces, move.promotion_piece())-polyglot_promotion_pieces.begin())<<12;
+		return polyglot_move;
+	}
+
+	Move Opening_book::from_polyglot_move(const State& state, const std::uint16_t polyglot_move) noexcept
+	{
+		Position destination{(polyglot_move>>3) & 7, polyglot_move & 7};
+		const Position from{(polyglot_move>>9) & 7, (polyglot_move>>6) & 7};
+		const unsigned promotion{(polyglot_move>>12) & 7U};
+
+		const bool is_castling{state.sides[state.side_to_move].pieces[Piece::king].is_occupied(from) && state.sides[state.side_to_move].pieces[Piece::rook].is_occupied(destination)};
+		if(is_castling)
+			destination.file_=destination.file_>from.file_? 6 : 2;
+
+		if(promotion>0 && promotion<polyglot_promotion_pieces.size())
+			return Move{from, destination, polyglot_promotion_pieces[promotion]};
+		return Move{from, destination};
+	}
+}
@@ -0,0 +1,50 @@
+#ifndef Opening_book_h_INCLUDED
+#define Opening_book_h_INCLUDED
+
+#include "Memory_mapped_file.h"
+#include "Move.h"
+#include "State.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <random>
+
+namespace engine
+{
+	// a Polyglot book: 16 byte big endian entries of key, move, weight and learn, sorted by key
+	class Opening_book
+	{
+		public:
+
+		constexpr static std::size_t entry_size{16};
+
+		struct Entry
+		{
+			std::uint64_t key;
+			std::uint16_t move;
+			std::uint16_t weight;
+			std::uint32_t learn;
+		};
+
+		// an empty path closes the book
+		bool open(const std::filesystem::path& path) noexcept;
+		[[nodiscard]] inline bool is_open() const noexcept { return file_.has_value(); }
+
+		// a legal book move picked at random in proportion to its weight
+		[[nodiscard]] std::optional<Move> probe(const State& state) noexcept;
+
+		[[nodiscard]] static std::uint16_t to_polyglot_move(const State& state, const Move& move) noexcept;
+		[[nodiscard]] static Move from_polyglot_move(const State& state, const std::uint16_t polyglot_move) noexcept;
+
+		private:
+
+		[[nodiscard]] Entry entry(const std::size_t index) const noexcept;
+		[[nodiscard]] inline std::size_t size() const noexcept { return file_? file_->bytes().size()/entry_size : 0; }
+
+		std::optional<Memory_mapped_file> file_{};
+		std::mt19937 random_engine_{std::random_device{}()};
+	};
+}
+
+#endif // Opening_book_h_INCLUDED
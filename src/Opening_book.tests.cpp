@@ -0,0 +1,85 @@
+#include <doctest/doctest.h>
+
+#include "Move.h"
+#include "Opening_book.h"
+#include "State.h"
+#include "Transposition_table.h"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace engine;
+
+namespace
+{
+	void write_entry(std::ofstream& os, const std::uint64_t key, const std::uint16_t move, const std::uint16_t weight)
+	{
+		for(int shift{56}; shift>=0; shift-=8)
+			os.put(static_cast<char>(key>>shift));
+		os.put(static_cast<char>(move>>8)).put(static_cast<char>(move));
+		os.put(static_cast<char>(weight>>8)).put(static_cast<char>(weight));
+		for(int i{0}; i<4; ++i)
+			os.put(0);
+	}
+}
+
+TEST_SUITE("Opening_book.h")
+{
+	TEST_CASE("polyglot::hash")
+	{
+		// the en passant square only changes the key when a capture onto it is possible
+		REQUIRE(polyglot::hash(State{"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1"})==polyglot::hash(State{"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1"}));
+		REQUIRE(polyglot::hash(State{"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3"})!=polyglot::hash(State{"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq - 0 3"}));
+		REQUIRE(polyglot::hash(State{starting_fen})!=polyglot::hash(State{"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1"}));
+	}
+
+	TEST_CASE("polyglot::hash matches the keys of the book format")
+	{
+		// the reference keys published with the format, after 1.e4 d5 2.e5 f5 3.Ke2 Kf7 and after 1.a4 b5 2.h4 b4 3.c4 bxc3 4.Ra3
+		CHECK(polyglot::hash(State{starting_fen})==0x463b96181691fc9c);
+		CHECK(polyglot::hash(State{"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1"})==0x823c9b50fd114196);
+		CHECK(polyglot::hash(State{"rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2"})==0x0756b94461c50fb0);
+		CHECK(polyglot::hash(State{"rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2"})==0x662fafb965db29d4);
+		CHECK(polyglot::hash(State{"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3"})==0x22a48b5a8e47ff78);
+		CHECK(polyglot::hash(State{"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3"})==0x652a607ca3f242c1);
+		CHECK(polyglot::hash(State{"rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4"})==0x00fdd303c946bdd9);
+		CHECK(polyglot::hash(State{"rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3"})==0x3c8123ea7b067637);
+		CHECK(polyglot::hash(State{"rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4"})==0x5c3f9b829b279560);
+	}
+
+	TEST_CASE("move encoding")
+	{
+		const State state{"r3k2r/pppppppp/8/8/8/8/PPPPPPPP/R3K2R w KQkq - 0 1"};
+		const Move kingside_castle{Position{0, 4}, Position{0, 6}};
+		// castling is stored as e1h1
+		REQUIRE(Opening_book::to_polyglot_move(state, kingside_castle)==(7 | (4<<6)));
+		REQUIRE(Opening_book::from_polyglot_move(state, Opening_book::to_polyglot_move(state, kingside_castle))==kingside_castle);
+
+		const State promotion_state{"8/P6k/8/8/8/8/8/K7 w - - 0 1"};
+		const Move promotion{Position{6, 0}, Position{7, 0}, Piece::rook};
+		REQUIRE(Opening_book::from_polyglot_move(promotion_state, Opening_book::to_polyglot_move(promotion_state, promotion))==promotion);
+	}
+
+	TEST_CASE("probe()")
+	{
+		const State state{starting_fen};
+		const Move e2e4{Position{1, 4}, Position{3, 4}}, e2e5{Position{1, 4}, Position{4, 4}};
+		const std::filesystem::path path{std::filesystem::temp_directory_path()/"opening_book_test.bin"};
+		{
+			std::ofstream book{path, std::ios::binary};
+			const std::uint64_t key{polyglot::hash(state)};
+			// the illegal move stands in for a key collision
+			for(const auto& [entry_key, move, weight] : std::array<std::tuple<std::uint64_t, Move, std::uint16_t>, 3>{{{key-1, e2e4, 1}, {key, e2e5, 100}, {key, e2e4, 1}}})
+				write_entry(book, entry_key, Opening_book::to_polyglot_move(state, move), weight);
+		}
+
+		Opening_book opening_book;
+		REQUIRE_FALSE(opening_book.probe(state));
+		REQUIRE(opening_book.open(path));
+		REQUIRE(opening_book.probe(state)==e2e4);
+		REQUIRE_FALSE(opening_book.probe(State{"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1"}));
+
+		REQUIRE_FALSE(opening_book.open(""));
+		std::filesystem::remove(path);
+	}
+}
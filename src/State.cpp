@@ -8,34 +8,69 @@
 #include <algorithm>
 #include <cstdint>
 #include <ranges>
-#include <regex>
+#include <string_view>
 #include <sstream>
 
 using namespace engine;
 
-void State::validate_fen(const std::array<std::string, 6>& partitioned_fen) const
+void State::validate_fen(const std::array<std::string, 6>& partitioned_fen)
 {
+	// checked by hand rather than with regular expressions, fens are validated in bulk when a file of them is evaluated
+	const auto is_digit=[](const char letter){ return letter>='0' && letter<='9'; };
 	const auto [fen_piece_data, fen_active_color, fen_castling_availiability, fen_en_passant_target_square, fen_halfmove_clock, fen_fullmove_clock] = partitioned_fen;
 	auto ranks = std::ranges::views::split(fen_piece_data, '/');
 	if(std::ranges::distance(ranks) != 8)
 		throw std::invalid_argument("invalid piece data");
 	for(auto&& rank : ranks)
 	{
-		const bool double_empty_squares = std::regex_match(std::string{rank.begin(), rank.end()}, std::regex{"\\d{2}"});
-		const bool invalid_letters = std::ranges::any_of(rank, [](const char& letter){ return !std::regex_match(std::string{letter}, std::regex{"[1-8]|[pkqbnrPKQBNR]"}); });
+		const bool double_empty_squares = std::ranges::adjacent_find(rank, [&](const char letter, const char next_letter){ return is_digit(letter) && is_digit(next_letter); })!=rank.end();
+		const bool invalid_letters = std::ranges::any_of(rank, [](const char& letter){ return !std::string_view{"12345678pkqbnrPKQBNR"}.contains(letter); });
 		const std::uint8_t number_of_squares = std::ranges::fold_left(rank, 0, [](int current_count, const char& letter){ return isdigit(letter)? current_count+letter-'0' : current_count+1; });
 		if(invalid_letters || number_of_squares != 8 || double_empty_squares)
 			throw std::invalid_argument("invalid piece data");
-		if(fen_active_color != "w" && fen_active_color != "b")
-			throw std::invalid_argument("invalid active color");
-		if(!std::regex_match(fen_castling_availiability, std::regex{"^-$|^(KQ?k?q?|Qk?q?|kq?|q)$"}))
-			throw std::invalid_argument("invalid castling rights");
-		if(!std::regex_match(fen_en_passant_target_square, std::regex{"^(-|[a-h][36])$"}))
-			throw std::invalid_argument("invalid en passant square");
-		if(!std::ranges::all_of(fen_halfmove_clock, ::isdigit))
-			throw std::invalid_argument("invalid halfmove clock");
-		if(!std::ranges::all_of(fen_fullmove_clock, ::isdigit))
-			throw std::invalid_argument("invalid halfmove clock");
+	}
+	if(fen_active_color != "w" && fen_active_color != "b")
+		throw std::invalid_argument("invalid active color");
+	// "-" or some of KQkq in that order
+	const bool valid_castling_rights = fen_castling_availiability=="-"
+									   || (!fen_castling_availiability.empty() && std::ranges::is_sorted(fen_castling_availiability)
+										   && std::ranges::includes(std::string_view{"KQkq"}, fen_castling_availiability));
+	if(!valid_castling_rights)
+		throw std::invalid_argument("invalid castling rights");
+	const bool valid_en_passant_square = fen_en_passant_target_square=="-"
+										 || (fen_en_passant_target_square.size()==2 && fen_en_passant_target_square[0]>='a' && fen_en_passant_target_square[0]<='h'
+											 && (fen_en_passant_target_square[1]=='3' || fen_en_passant_target_square[1]=='6'));
+	if(!valid_en_passant_square)
+		throw std::invalid_argument("invalid en passant square");
+	if(!std::ranges::all_of(fen_halfmove_clock, is_digit))
+		throw std::invalid_argument("invalid halfmove clock");
+	if(!std::ranges::all_of(fen_fullmove_clock, is_digit))
+		throw std::invalid_argument("invalid halfmove clock");
+}
+
+std::array<std::string, 6> State::partition_fen(const std::string_view fen)
+{
+	std::istringstream iss{std::string{fen}};
+	std::array<std::string, 6> partitioned_fen;
+	for(auto& partition : partitioned_fen)
+		std::getline(iss, partition, ' ');
+	return partitioned_fen;
+}
+
+bool State::is_valid_fen(const std::string_view fen) noexcept
+{
+	try
+	{
+		const auto partitioned_fen{partition_fen(fen)};
+		validate_fen(partitioned_fen);
+		// the clocks are read as numbers and every position needs both kings
+		const auto& [fen_piece_data, fen_active_color, fen_castling_availiability, fen_en_passant_target_square, fen_halfmove_clock, fen_fullmove_clock] = partitioned_fen;
+		return !fen_halfmove_clock.empty() && !fen_fullmove_clock.empty()
+			   && std::ranges::count(fen_piece_data, 'K')==1 && std::ranges::count(fen_piece_data, 'k')==1;
+	}
+	catch(const std::exception&)
+	{
+		return false;
 	}
 }
 
@@ -90,10 +125,7 @@ void State::parse_fen(const std::string_view fen) noexcept
 		}
 	};
 
-	std::istringstream iss{std::string{fen}};
-	std::array<std::string, 6> partitioned_fen;
-	for(auto& partition : partitioned_fen)
-		std::getline(iss, partition, ' ');
+	std::array<std::string, 6> partitioned_fen{partition_fen(fen)};
 	for(bool invalid_input{true}; invalid_input;)
 	{
 		try
@@ -106,9 +138,7 @@ void State::parse_fen(const std::string_view fen) noexcept
 			std::cout << "Invalid fen string: " << exception.what() << "\n";
 			std::string new_fen;
 			std::getline(std::cin, new_fen);
-			std::istringstream iss{std::string{new_fen}};
-			for(auto& partition : partitioned_fen)
-				std::getline(iss, partition, ' ');
+			partitioned_fen=partition_fen(new_fen);
 		}
 	}
 	const auto [fen_piece_data, fen_active_color, fen_castling_availiability, fen_en_passant_target_square, fen_halfmove_clock, fen_fullmove_clock] = partitioned_fen;
@@ -145,6 +175,8 @@ State::State(const std::string_view fen)
 	enemy_attack_map = generate_attack_map(*this);
 	side_to_move = other_side(side_to_move);
 	zobrist_hash = zobrist::hash(*this);
+	pawn_hash = zobrist::pawn_hash(*this);
+	material_hash = zobrist::material_hash(*this);
 	repetition_history.push_back(zobrist_hash);
 }
 
@@ -188,7 +220,7 @@ std::vector<State::Piece_and_data> State::get_board_data() const noexcept
 	return board_data;
 }
 
-Fixed_capacity_vector<std::uint16_t, board_size*board_size> State::to_halfKP_features(const Side perspective) const noexcept
+Fixed_capacity_vector<std::uint16_t, board_size*board_size> State::to_features(const Side perspective) const noexcept
 {
 	Fixed_capacity_vector<std::uint16_t,board_size*board_size> active_feature_indexes;
 	Position king_square{sides[perspective].pieces[Piece::king].lsb_square()};
@@ -196,7 +228,7 @@ Fixed_capacity_vector<std::uint16_t, board_size*board_size> State::to_halfKP_fea
 	{
 		for(const auto& piece : all_pieces)
 		{
-			if(piece==Piece::king)
+			if(piece==Piece::king && !Neural_network::king_is_feature)
 				continue;
 
 			sides[current_side].pieces[piece].for_each_piece([&](const Position& piece_square)
@@ -208,7 +240,9 @@ Fixed_capacity_vector<std::uint16_t, board_size*board_size> State::to_halfKP_fea
 	return active_feature_indexes;
 }
 
-int State::evaluate(const Neural_network& neural_network, const engine::Side_map<std::array<std::int16_t, Feature_transformer::dimensions.neurons>>& accumulator) const noexcept
+int State::evaluate(const Neural_network& neural_network, const Neural_network::Accumulator& accumulator) const noexcept
 {
-	return neural_network.evaluate(side_to_move, accumulator);
+	// only nets with several layer stacks look at the material
+	const std::size_t number_of_pieces{Neural_network::layer_stacks>1? occupied_squares().popcount() : std::size_t{0}};
+	return neural_network.evaluate(side_to_move, number_of_pieces, accumulator);
 }
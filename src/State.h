@@ -6,7 +6,7 @@
 #include "Enum_map.h"
 #include "Fixed_capacity_vector.h"
 #include "Move.h"
-#include "nnue/layers/Feature_transformer.h"
+#include "nnue/Neural_network.h"
 #include "Position.h"
 
 #include <algorithm>
@@ -15,8 +15,6 @@
 #include <stack>
 #include <vector>
 
-class Neural_network;
-
 namespace engine
 {
 	enum class Castling_rights { kingside, queenside, size };
@@ -65,6 +63,9 @@ namespace engine
 		explicit State(const std::string_view fen);
 		State() = default;
 
+		// the constructor asks for another fen on the console when one is invalid, this only checks it
+		[[nodiscard]] static bool is_valid_fen(const std::string_view fen) noexcept;
+
 		struct Piece_and_data
 		{
 			Piece piece;
@@ -83,6 +84,8 @@ namespace engine
 			Castling_rights_map<bool> white_castling_rights;
 			Castling_rights_map<bool> black_castling_rights;
 			std::uint64_t previous_zobrist_hash;
+			std::uint64_t previous_pawn_hash;
+			std::uint64_t previous_material_hash;
 			unsigned half_move_clock;
 
 			constexpr bool operator==(const State_delta& state_delta) const = default;
@@ -94,6 +97,8 @@ namespace engine
 		Bitboard enemy_attack_map{0ULL};
 		std::optional<Position> en_passant_target_square{std::nullopt};
 		std::uint64_t zobrist_hash;
+		// keys for the pawn structure and the piece counts alone, used to index correction history
+		std::uint64_t pawn_hash, material_hash;
 		std::vector<std::uint64_t> repetition_history{};
 		std::stack<State_delta> history{};
 
@@ -103,14 +108,16 @@ namespace engine
 		[[nodiscard]] std::vector<Piece_and_data> get_board_data() const noexcept;
 		[[nodiscard]] bool is_stalemate() const noexcept;
 		[[nodiscard]] std::optional<Piece> piece_at(const Position& position, const Side& side) const noexcept;
-		[[nodiscard]] Fixed_capacity_vector<std::uint16_t,board_size*board_size> to_halfKP_features(const Side perspective) const noexcept;
-		[[nodiscard]] int evaluate(const Neural_network& neural_network, const engine::Side_map<std::array<std::int16_t, Feature_transformer::dimensions.neurons>>& accumulator) const noexcept;
+		[[nodiscard]] Fixed_capacity_vector<std::uint16_t,board_size*board_size> to_features(const Side perspective) const noexcept;
+		[[nodiscard]] int evaluate(const Neural_network& neural_network, const Neural_network::Accumulator& accumulator) const noexcept;
 
+		bool operator==(const State&) const = default;
 		friend std::ostream& operator<<(std::ostream& os, const State& state);
 
 		private:
 
-		void validate_fen(const std::array<std::string, 6>& partitioned_fen) const;
+		static void validate_fen(const std::array<std::string, 6>& partitioned_fen);
+		[[nodiscard]] static std::array<std::string, 6> partition_fen(const std::string_view fen);
 		void parse_fen(const std::string_view fen) noexcept;
 		void update_castling_rights(const Side& side) noexcept;
 	};
@@ -1,6 +1,7 @@
 #include <doctest/doctest.h>
 
 #include "Move.h"
+#include "move_unmove.h"
 #include "State.h"
 
 using namespace engine;
@@ -28,7 +29,7 @@ TEST_SUITE("State.h")
 		State state{"r4rk1/pppqbp1p/2n1pnp1/1b1p4/3PP3/4BNP1/PPPQNPBP/R4RK1 w - - 0 1"};
 		const State state_copy{state};
 		const Position origin_square{3, 4}, destination_square{4, 4};
-		state.make(Move{origin_square, destination_square});
+		make(state, Move{origin_square, destination_square});
 
 		CHECK_FALSE(state.piece_at(origin_square, Side::white));
 		CHECK(state.piece_at(destination_square, Side::white)==Piece::pawn);
@@ -55,9 +56,59 @@ TEST_SUITE("State.h")
 		{
 			State state{fen};
 			const State state_copy{state};
-			state.make(move);
-			state.unmove();
+			make(state, move);
+			unmove(state);
 			CHECK(state==state_copy);
 		}
 	}
+
+	TEST_CASE("is_valid_fen()")
+	{
+		CHECK(State::is_valid_fen(starting_fen));
+		CHECK(State::is_valid_fen("r3k2r/8/8/8/8/8/8/R3K2R b - - 12 40"));
+
+		SUBCASE("castling rights")
+		{
+			CHECK(State::is_valid_fen("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1"));
+			CHECK(State::is_valid_fen("r3k2r/8/8/8/8/8/8/R3K2R w Qk - 0 1"));
+			CHECK_FALSE(State::is_valid_fen("r3k2r/8/8/8/8/8/8/R3K2R w KK - 0 1"));
+			CHECK_FALSE(State::is_valid_fen("r3k2r/8/8/8/8/8/8/R3K2R w qK - 0 1"));
+			CHECK_FALSE(State::is_valid_fen("r3k2r/8/8/8/8/8/8/R3K2R w KQkqK - 0 1"));
+			CHECK_FALSE(State::is_valid_fen("r3k2r/8/8/8/8/8/8/R3K2R w  - 0 1"));
+		}
+
+		SUBCASE("en passant square")
+		{
+			CHECK(State::is_valid_fen("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1"));
+			CHECK(State::is_valid_fen("rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2"));
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e4 0 1"));
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq i3 0 1"));
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e 0 1"));
+		}
+
+		SUBCASE("piece data")
+		{
+			// empty squares are written as one digit
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/44/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"));
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/8/1P15/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"));
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"));
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"));
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR/8 w KQkq - 0 1"));
+		}
+
+		SUBCASE("kings")
+		{
+			CHECK_FALSE(State::is_valid_fen("rnbq1bnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQ - 0 1"));
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQ1BNR w kq - 0 1"));
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBKKBNR w kq - 0 1"));
+		}
+
+		SUBCASE("clocks")
+		{
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -"));
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0"));
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - x 1"));
+			CHECK_FALSE(State::is_valid_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 -1"));
+		}
+	}
 }
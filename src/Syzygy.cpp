@@ -0,0 +1,1067 @@
+#include "Syzygy.h"
+
+#include "Memory_mapped_file.h"
+#include "Move_generator.h"
+#include "move_unmove.h"
+#include "Pieces.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <ranges>
+#include <string>
+#include <utility>
+
+namespace engine::syzygy
+{
+	namespace
+	{
+		constexpr unsigned max_table_pieces{7};
+		constexpr std::array<std::uint8_t, 4> wdl_magic{0xD7, 0x66, 0x0C, 0xA5}, dtz_magic{0x71, 0xE8, 0x23, 0x5D};
+		constexpr std::string_view wdl_extension{".rtbw"}, dtz_extension{".rtbz"};
+		constexpr std::string_view table_piece_characters{"KQRBNP"};
+		// root move ranks stay clear of every distance to zeroing the tables can hold
+		constexpr int max_dtz{1<<18};
+
+		// per table flags, most of them only describe how dtz values are stored
+		constexpr std::uint8_t side_to_move_flag{1}, mapped_flag{2}, win_plies_flag{4}, loss_plies_flag{8}, wide_flag{16}, single_value_flag{128};
+
+		enum class Table_type { wdl, dtz };
+
+		// zeroing_best_move means a capture or pawn move is best, so the dtz table can not be trusted
+		enum class Probe_state { fail, ok, change_side_to_move, zeroing_best_move };
+
+		template <typename Integral_type>
+		[[nodiscard]] Integral_type read_little_endian(const std::uint8_t* data) noexcept
+		{
+			Integral_type value;
+			std::memcpy(&value, data, sizeof(value));
+			if constexpr(std::endian::native==std::endian::big)
+				value=std::byteswap(value);
+			return value;
+		}
+
+		template <typename Integral_type>
+		[[nodiscard]] Integral_type read_big_endian(const std::uint8_t* data) noexcept
+		{
+			Integral_type value;
+			std::memcpy(&value, data, sizeof(value));
+			if constexpr(std::endian::native==std::endian::little)
+				value=std::byteswap(value);
+			return value;
+		}
+
+		// the tables index squares a1=0 to h8=63 like Position does
+		[[nodiscard]] constexpr int rank_of(const int square) noexcept { return square>>3; }
+		[[nodiscard]] constexpr int file_of(const int square) noexcept { return square&7; }
+		[[nodiscard]] constexpr int off_diagonal(const int square) noexcept { return rank_of(square)-file_of(square); }
+		[[nodiscard]] constexpr int flip_file(const int square) noexcept { return square^7; }
+		[[nodiscard]] constexpr int flip_rank(const int square) noexcept { return square^56; }
+		[[nodiscard]] constexpr int flip_diagonal(const int square) noexcept { return ((square>>3) | (square<<3)) & 63; }
+
+		// the generator's piece codes, colour in bit 3 and pawn=1 to king=6
+		[[nodiscard]] constexpr std::uint8_t to_table_piece(const Piece piece, const Side side) noexcept
+		{
+			return (piece==Piece::king? 6 : std::to_underlying(piece)) | (side==Side::black? 8 : 0);
+		}
+
+		struct Encoding_tables
+		{
+			// a2-h7 to 0-47, the leading pawn is the one with the highest value
+			std::array<int, 64> pawn_map{};
+			// squares below the a1-h8 diagonal to 0-27
+			std::array<int, 64> below_diagonal_map{};
+			// the a1-d1-d4 triangle to 0-9, -1 elsewhere
+			std::array<int, 64> triangle_map{};
+			// the 462 placements of two kings with the first one in the triangle
+			std::array<std::array<int, 64>, 10> king_pair_map{};
+			std::array<std::array<std::uint64_t, 64>, max_table_pieces> binomial{};
+			std::array<std::array<std::uint64_t, 64>, max_table_pieces> lead_pawn_index{};
+			std::array<std::array<std::uint64_t, 4>, max_table_pieces> lead_pawns_size{};
+		};
+
+		constexpr Encoding_tables encoding_tables=[]() constexpr
+		{
+			Encoding_tables tables{};
+
+			int code{0};
+			for(int square{0}; square<64; ++square)
+				if(off_diagonal(square)<0)
+					tables.below_diagonal_map[square]=code++;
+
+			// diagonal squares of the triangle come last
+			code=0;
+			std::array<int, 4> diagonal{};
+			std::size_t diagonal_size{0};
+			tables.triangle_map.fill(-1);
+			for(int rank{0}; rank<4; ++rank)
+				for(int file{0}; file<4; ++file)
+				{
+					const int square{rank*8+file};
+					if(off_diagonal(square)<0)
+						tables.triangle_map[square]=code++;
+					else if(off_diagonal(square)==0)
+						diagonal[diagonal_size++]=square;
+				}
+			for(std::size_t i{0}; i<diagonal_size; ++i)
+				tables.triangle_map[diagonal[i]]=code++;
+
+			// with the first king on the diagonal the second one is never above it, both on the diagonal come last
+			code=0;
+			std::array<std::pair<int, int>, 64> both_on_diagonal{};
+			std::size_t both_on_diagonal_size{0};
+			for(int triangle_index{0}; triangle_index<10; ++triangle_index)
+				for(int king_square{0}; king_square<64; ++king_square)
+				{
+					if(tables.triangle_map[king_square]!=triangle_index)
+						continue;
+					for(int other_king_square{0}; other_king_square<64; ++other_king_square)
+					{
+						const bool is_adjacent{std::max(std::abs(rank_of(king_square)-rank_of(other_king_square)), std::abs(file_of(king_square)-file_of(other_king_square)))<=1};
+						if(is_adjacent)
+							continue;
+						if(!off_diagonal(king_square) && off_diagonal(other_king_square)>0)
+							continue;
+						if(!off_diagonal(king_square) && !off_diagonal(other_king_square))
+							both_on_diagonal[both_on_diagonal_size++]={triangle_index, other_king_square};
+						else
+							tables.king_pair_map[triangle_index][other_king_square]=code++;
+					}
+				}
+			for(std::size_t i{0}; i<both_on_diagonal_size; ++i)
+				tables.king_pair_map[both_on_diagonal[i].first][both_on_diagonal[i].second]=code++;
+
+			for(int n{0}; n<64; ++n)
+				for(unsigned k{0}; k<max_table_pieces; ++k)
+					tables.binomial[k][n]=k==0? 1 : n==0? 0 : tables.binomial[k-1][n-1]+tables.binomial[k][n-1];
+
+			// tables with pawns are split by the leading pawn's file, so every file restarts the index
+			int available_squares{47};
+			for(unsigned lead_pawns_count{1}; lead_pawns_count<=5; ++lead_pawns_count)
+				for(int file{0}; file<4; ++file)
+				{
+					std::uint64_t index{0};
+					for(int rank{1}; rank<7; ++rank)
+					{
+						const int square{rank*8+file};
+						if(lead_pawns_count==1)
+						{
+							tables.pawn_map[square]=available_squares--;
+							tables.pawn_map[flip_file(square)]=available_squares--;
+						}
+						tables.lead_pawn_index[lead_pawns_count][square]=index;
+						index+=tables.binomial[lead_pawns_count-1][tables.pawn_map[square]];
+					}
+					tables.lead_pawns_size[lead_pawns_count][file]=index;
+				}
+
+			return tables;
+		}();
+
+		using Material=Side_map<Piece_map<unsigned>>;
+
+		[[nodiscard]] std::uint64_t material_key(const Material& material) noexcept
+		{
+			std::uint64_t key{0};
+			unsigned shift{0};
+			for(const auto side : all_sides)
+				for(const auto piece : all_pieces)
+				{
+					key|=static_cast<std::uint64_t>(material[side][piece])<<shift;
+					shift+=4;
+				}
+			return key;
+		}
+
+		[[nodiscard]] Material to_material(const State& state) noexcept
+		{
+			Material material{};
+			for(const auto side : all_sides)
+				for(const auto piece : all_pieces)
+					material[side][piece]=state.sides[side].pieces[piece].popcount();
+			return material;
+		}
+
+		// "KRPvKB" to its material, white being the first side
+		[[nodiscard]] std::optional<Material> parse_table_name(const std::string_view name) noexcept
+		{
+			const auto separator{name.find('v')};
+			if(separator==std::string_view::npos)
+				return std::nullopt;
+
+			Material material{};
+			const std::array<std::string_view, 2> sides{name.substr(0, separator), name.substr(separator+1)};
+			constexpr std::array<Piece, 6> to_piece{Piece::king, Piece::queen, Piece::rook, Piece::bishop, Piece::knight, Piece::pawn};
+			for(const auto side : all_sides)
+			{
+				for(const char character : sides[std::to_underlying(side)])
+				{
+					const auto piece_index{table_piece_characters.find(character)};
+					if(piece_index==std::string_view::npos)
+						return std::nullopt;
+					++material[side][to_piece[piece_index]];
+				}
+				if(material[side][Piece::king]!=1)
+					return std::nullopt;
+			}
+			return material;
+		}
+
+		[[nodiscard]] bool is_capture(const State& state, const Move& move) noexcept
+		{
+			const bool is_en_passant{state.en_passant_target_square==move.destination_square() && state.sides[state.side_to_move].pieces[Piece::pawn].is_occupied(move.from_square())};
+			return is_en_passant || state.sides[other_side(state.side_to_move)].occupied_squares().is_occupied(move.destination_square());
+		}
+
+		[[nodiscard]] bool is_zeroing(const State& state, const Move& move) noexcept
+		{
+			return is_capture(state, move) || state.sides[state.side_to_move].pieces[Piece::pawn].is_occupied(move.from_square());
+		}
+
+		[[nodiscard]] constexpr Wdl operator-(const Wdl wdl) noexcept
+		{
+			return static_cast<Wdl>(-std::to_underlying(wdl));
+		}
+
+		[[nodiscard]] constexpr int sign_of(const int value) noexcept
+		{
+			return (value>0)-(value<0);
+		}
+
+		// the dtz of the zeroing move that reached a position with this result
+		[[nodiscard]] constexpr int dtz_before_zeroing(const Wdl wdl) noexcept
+		{
+			switch(wdl)
+			{
+				case Wdl::win: return 1;
+				case Wdl::cursed_win: return 101;
+				case Wdl::blessed_loss: return -101;
+				case Wdl::loss: return -1;
+				default: return 0;
+			}
+		}
+
+		// only the positions since the last zeroing move can repeat
+		[[nodiscard]] bool has_repeated(const State& state) noexcept
+		{
+			const auto& history{state.repetition_history};
+			const std::size_t reversible_plies{std::min<std::size_t>(state.half_move_clock+1, history.size())};
+			for(std::size_t i{history.size()-reversible_plies}; i<history.size(); ++i)
+				if(std::find(history.begin()+i+1, history.end(), history[i])!=history.end())
+					return true;
+			return false;
+		}
+	}
+
+	// the layout of one compressed sub table, pointers point into the mapped file
+	struct Pairs_data
+	{
+		std::uint8_t flags{0};
+		std::uint8_t max_symbol_length{0}, min_symbol_length{0};
+		std::uint32_t number_of_blocks{0};
+		std::size_t block_size{0};
+		// about every span values there is a sparse index entry
+		std::size_t span{0};
+		const std::uint8_t* lowest_symbols{nullptr};
+		const std::uint8_t* symbol_tree{nullptr};
+		const std::uint8_t* block_lengths{nullptr};
+		std::size_t block_lengths_size{0};
+		const std::uint8_t* sparse_index{nullptr};
+		std::size_t sparse_index_size{0};
+		const std::uint8_t* data{nullptr};
+		std::vector<std::uint64_t> base64{};
+		std::vector<std::uint8_t> symbol_lengths{};
+		std::array<std::uint8_t, max_table_pieces> pieces{};
+		std::array<std::uint64_t, max_table_pieces+1> group_index{};
+		std::array<int, max_table_pieces+1> group_length{};
+		std::array<std::uint16_t, 4> dtz_map_index{};
+	};
+
+	struct Table
+	{
+		std::filesystem::path path{};
+		std::once_flag mapping_flag{};
+		bool is_mapped{false};
+		std::optional<Memory_mapped_file> file{};
+		const std::uint8_t* dtz_map{nullptr};
+		// [side to move][leading pawn file]
+		std::array<std::array<Pairs_data, 4>, 2> items{};
+	};
+
+	struct Table_pair
+	{
+		std::string name;
+		std::uint64_t key, mirrored_key;
+		unsigned piece_count;
+		bool has_pawns, has_unique_pieces;
+		// the leading side's pawns first, the side with fewer pawns leads
+		std::array<unsigned, 2> pawn_count;
+		Table wdl, dtz;
+
+		[[nodiscard]] Table& table(const Table_type type) noexcept { return type==Table_type::wdl? wdl : dtz; }
+
+		[[nodiscard]] Pairs_data& pairs_data(const Table_type type, const int side_to_move, const int file) noexcept
+		{
+			// dtz tables store one side to move, symmetric wdl tables only white to move
+			const int sides{type==Table_type::wdl && key!=mirrored_key? 2 : 1};
+			return table(type).items[side_to_move%sides][has_pawns? file : 0];
+		}
+	};
+
+	namespace
+	{
+		[[nodiscard]] std::uint16_t left_symbol(const Pairs_data& pairs_data, const std::uint16_t symbol) noexcept
+		{
+			const std::uint8_t* node{pairs_data.symbol_tree+3*symbol};
+			return ((node[1] & 0xF)<<8) | node[0];
+		}
+
+		[[nodiscard]] std::uint16_t right_symbol(const Pairs_data& pairs_data, const std::uint16_t symbol) noexcept
+		{
+			const std::uint8_t* node{pairs_data.symbol_tree+3*symbol};
+			return (node[2]<<4) | (node[1]>>4);
+		}
+
+		[[nodiscard]] int block_length(const Pairs_data& pairs_data, const std::uint32_t block) noexcept
+		{
+			return read_little_endian<std::uint16_t>(pairs_data.block_lengths+2*block);
+		}
+
+		// the number of original symbols a symbol expands to, minus one
+		std::uint8_t set_symbol_length(Pairs_data& pairs_data, const std::uint16_t symbol, std::vector<bool>& visited) noexcept
+		{
+			// the tree is acyclic, so marking it before the recursion is safe
+			visited[symbol]=true;
+			const std::uint16_t right{right_symbol(pairs_data, symbol)};
+			if(right==0xFFF)
+				return 0;
+			const std::uint16_t left{left_symbol(pairs_data, symbol)};
+			if(!visited[left])
+				pairs_data.symbol_lengths[left]=set_symbol_length(pairs_data, left, visited);
+			if(!visited[right])
+				pairs_data.symbol_lengths[right]=set_symbol_length(pairs_data, right, visited);
+			return pairs_data.symbol_lengths[left]+pairs_data.symbol_lengths[right]+1;
+		}
+
+		void set_groups(const Table_pair& table_pair, Pairs_data& pairs_data, const std::array<int, 2>& order, const int file) noexcept
+		{
+			// leading pieces are encoded together: three unique pieces with the kings, otherwise only the kings
+			int groups{0}, first_length{table_pair.has_pawns? 0 : table_pair.has_unique_pieces? 3 : 2};
+			pairs_data.group_length[groups]=1;
+			for(unsigned i{1}; i<table_pair.piece_count; ++i)
+			{
+				if(--first_length>0 || pairs_data.pieces[i]==pairs_data.pieces[i-1])
+					++pairs_data.group_length[groups];
+				else
+					pairs_data.group_length[++groups]=1;
+			}
+			pairs_data.group_length[++groups]=0;
+
+			// the file decides in which order the groups make up the index
+			const bool pawns_on_both_sides{table_pair.has_pawns && table_pair.pawn_count[1]>0};
+			int next{pawns_on_both_sides? 2 : 1};
+			int free_squares{64-pairs_data.group_length[0]-(pawns_on_both_sides? pairs_data.group_length[1] : 0)};
+			std::uint64_t index{1};
+			for(int k{0}; next<groups || k==order[0] || k==order[1]; ++k)
+			{
+				if(k==order[0])
+				{
+					pairs_data.group_index[0]=index;
+					index*=table_pair.has_pawns? encoding_tables.lead_pawns_size[pairs_data.group_length[0]][file] : table_pair.has_unique_pieces? 31332 : 462;
+				}
+				else if(k==order[1])
+				{
+					pairs_data.group_index[1]=index;
+					index*=encoding_tables.binomial[pairs_data.group_length[1]][48-pairs_data.group_length[0]];
+				}
+				else
+				{
+					pairs_data.group_index[next]=index;
+					index*=encoding_tables.binomial[pairs_data.group_length[next]][free_squares];
+					free_squares-=pairs_data.group_length[next++];
+				}
+			}
+			pairs_data.group_index[groups]=index;
+		}
+
+		const std::uint8_t* set_sizes(Pairs_data& pairs_data, const std::uint8_t* data) noexcept
+		{
+			pairs_data.flags=*data++;
+			if(pairs_data.flags & single_value_flag)
+			{
+				// the single value is kept in min_symbol_length
+				pairs_data.min_symbol_length=*data++;
+				return data;
+			}
+
+			const auto groups_end{std::ranges::find(pairs_data.group_length, 0)};
+			const std::uint64_t table_size{pairs_data.group_index[groups_end-pairs_data.group_length.begin()]};
+
+			pairs_data.block_size=std::size_t{1}<<*data++;
+			pairs_data.span=std::size_t{1}<<*data++;
+			pairs_data.sparse_index_size=(table_size+pairs_data.span-1)/pairs_data.span;
+			const std::uint8_t padding{*data++};
+			pairs_data.number_of_blocks=read_little_endian<std::uint32_t>(data);
+			data+=sizeof(std::uint32_t);
+			// padded so that the sparse index never points past the end
+			pairs_data.block_lengths_size=pairs_data.number_of_blocks+padding;
+			pairs_data.max_symbol_length=*data++;
+			pairs_data.min_symbol_length=*data++;
+			pairs_data.lowest_symbols=data;
+
+			// canonical huffman code, longer symbols have lower values, so base64 is decreasing in the symbol length
+			const auto lowest_symbol=[&](const std::size_t length){ return read_little_endian<std::uint16_t>(pairs_data.lowest_symbols+2*length); };
+			pairs_data.base64.assign(pairs_data.max_symbol_length-pairs_data.min_symbol_length+1, 0);
+			for(int i{static_cast<int>(pairs_data.base64.size())-2}; i>=0; --i)
+				pairs_data.base64[i]=(pairs_data.base64[i+1]+lowest_symbol(i)-lowest_symbol(i+1))/2;
+			for(std::size_t i{0}; i<pairs_data.base64.size(); ++i)
+				pairs_data.base64[i]<<=64-i-pairs_data.min_symbol_length;
+			data+=pairs_data.base64.size()*sizeof(std::uint16_t);
+
+			pairs_data.symbol_lengths.assign(read_little_endian<std::uint16_t>(data), 0);
+			data+=sizeof(std::uint16_t);
+			pairs_data.symbol_tree=data;
+
+			// pairs of symbols are recursively replaced by new symbols, the lengths say how far each one expands
+			std::vector<bool> visited(pairs_data.symbol_lengths.size());
+			for(std::uint16_t symbol{0}; symbol<pairs_data.symbol_lengths.size(); ++symbol)
+				if(!visited[symbol])
+					pairs_data.symbol_lengths[symbol]=set_symbol_length(pairs_data, symbol, visited);
+
+			return data+pairs_data.symbol_lengths.size()*3+(pairs_data.symbol_lengths.size() & 1);
+		}
+
+		const std::uint8_t* set_dtz_map(Table& table, const std::uint8_t* data, const int max_file) noexcept
+		{
+			table.dtz_map=data;
+			for(int file{0}; file<=max_file; ++file)
+			{
+				Pairs_data& pairs_data{table.items[0][file]};
+				if(!(pairs_data.flags & mapped_flag))
+					continue;
+				if(pairs_data.flags & wide_flag)
+				{
+					data+=reinterpret_cast<std::uintptr_t>(data) & 1;
+					for(auto& map_index : pairs_data.dtz_map_index)
+					{
+						map_index=static_cast<std::uint16_t>((data-table.dtz_map)/2+1);
+						data+=2*read_little_endian<std::uint16_t>(data)+2;
+					}
+				}
+				else
+				{
+					for(auto& map_index : pairs_data.dtz_map_index)
+					{
+						map_index=static_cast<std::uint16_t>(data-table.dtz_map+1);
+						data+=*data+1;
+					}
+				}
+			}
+			return data+(reinterpret_cast<std::uintptr_t>(data) & 1);
+		}
+
+		[[nodiscard]] bool parse_table(Table_pair& table_pair, const Table_type type, const std::uint8_t* data) noexcept
+		{
+			constexpr std::uint8_t split_flag{1}, has_pawns_flag{2};
+			if(static_cast<bool>(*data & has_pawns_flag)!=table_pair.has_pawns || (type==Table_type::wdl && static_cast<bool>(*data & split_flag)!=(table_pair.key!=table_pair.mirrored_key)))
+				return false;
+			++data;
+
+			Table& table{table_pair.table(type)};
+			const int sides{type==Table_type::wdl && table_pair.key!=table_pair.mirrored_key? 2 : 1};
+			const int max_file{table_pair.has_pawns? 3 : 0};
+			const bool pawns_on_both_sides{table_pair.has_pawns && table_pair.pawn_count[1]>0};
+
+			for(int file{0}; file<=max_file; ++file)
+			{
+				const std::array<std::array<int, 2>, 2> order
+				{{
+					{data[0] & 0xF, pawns_on_both_sides? data[1] & 0xF : 0xF},
+					{data[0]>>4, pawns_on_both_sides? data[1]>>4 : 0xF}
+				}};
+				data+=1+pawns_on_both_sides;
+
+				for(unsigned k{0}; k<table_pair.piece_count; ++k, ++data)
+					for(int side{0}; side<sides; ++side)
+						table.items[side][file].pieces[k]=side? *data>>4 : *data & 0xF;
+
+				for(int side{0}; side<sides; ++side)
+					set_groups(table_pair, table.items[side][file], order[side], file);
+			}
+
+			data+=reinterpret_cast<std::uintptr_t>(data) & 1;
+
+			for(int file{0}; file<=max_file; ++file)
+				for(int side{0}; side<sides; ++side)
+					data=set_sizes(table.items[side][file], data);
+
+			if(type==Table_type::dtz)
+				data=set_dtz_map(table, data, max_file);
+
+			for(int file{0}; file<=max_file; ++file)
+				for(int side{0}; side<sides; ++side)
+				{
+					table.items[side][file].sparse_index=data;
+					data+=table.items[side][file].sparse_index_size*6;
+				}
+
+			for(int file{0}; file<=max_file; ++file)
+				for(int side{0}; side<sides; ++side)
+				{
+					table.items[side][file].block_lengths=data;
+					data+=table.items[side][file].block_lengths_size*sizeof(std::uint16_t);
+				}
+
+			for(int file{0}; file<=max_file; ++file)
+				for(int side{0}; side<sides; ++side)
+				{
+					// blocks are cache line aligned relative to the start of the file
+					const std::uint8_t* const file_start{table.file->bytes().data()};
+					data=file_start+((data-file_start+63) & ~std::ptrdiff_t{63});
+					table.items[side][file].data=data;
+					data+=static_cast<std::uint64_t>(table.items[side][file].number_of_blocks)*table.items[side][file].block_size;
+				}
+
+			return data<=table.file->bytes().data()+table.file->bytes().size();
+		}
+
+		[[nodiscard]] bool ensure_mapped(Table_pair& table_pair, const Table_type type) noexcept
+		{
+			Table& table{table_pair.table(type)};
+			// the first thread to need a table maps it, the others wait for it
+			std::call_once(table.mapping_flag, [&]()
+			{
+				if(table.path.empty())
+					return;
+				table.file=Memory_mapped_file::open(table.path);
+				const auto& magic{type==Table_type::wdl? wdl_magic : dtz_magic};
+				if(!table.file || table.file->bytes().size()%64!=16 || !std::ranges::equal(table.file->bytes().first(magic.size()), magic))
+				{
+					table.file.reset();
+					return;
+				}
+				table.is_mapped=parse_table(table_pair, type, table.file->bytes().data()+magic.size());
+			});
+			return table.is_mapped;
+		}
+
+		[[nodiscard]] int decompress_pairs(const Pairs_data& pairs_data, const std::uint64_t index) noexcept
+		{
+			if(pairs_data.flags & single_value_flag)
+				return pairs_data.min_symbol_length;
+
+			// the sparse index gives a block and an offset close to the value, walk the block lengths from there
+			const std::uint8_t* sparse_entry{pairs_data.sparse_index+6*(index/pairs_data.span)};
+			std::uint32_t block{read_little_endian<std::uint32_t>(sparse_entry)};
+			int offset{read_little_endian<std::uint16_t>(sparse_entry+4)+static_cast<int>(index%pairs_data.span)-static_cast<int>(pairs_data.span/2)};
+			while(offset<0)
+				offset+=block_length(pairs_data, --block)+1;
+			while(offset>block_length(pairs_data, block))
+				offset-=block_length(pairs_data, block++)+1;
+
+			const std::uint8_t* block_data{pairs_data.data+static_cast<std::uint64_t>(block)*pairs_data.block_size};
+			std::uint64_t buffer{read_big_endian<std::uint64_t>(block_data)};
+			block_data+=sizeof(std::uint64_t);
+			int buffer_size{64};
+			std::uint16_t symbol;
+			while(true)
+			{
+				std::size_t length{0};
+				while(buffer<pairs_data.base64[length])
+					++length;
+				symbol=static_cast<std::uint16_t>((buffer-pairs_data.base64[length])>>(64-length-pairs_data.min_symbol_length));
+				symbol+=read_little_endian<std::uint16_t>(pairs_data.lowest_symbols+2*length);
+				if(offset<pairs_data.symbol_lengths[symbol]+1)
+					break;
+				offset-=pairs_data.symbol_lengths[symbol]+1;
+				length+=pairs_data.min_symbol_length;
+				buffer<<=length;
+				buffer_size-=length;
+				if(buffer_size<=32)
+				{
+					buffer_size+=32;
+					buffer|=static_cast<std::uint64_t>(read_big_endian<std::uint32_t>(block_data))<<(64-buffer_size);
+					block_data+=sizeof(std::uint32_t);
+				}
+			}
+
+			while(pairs_data.symbol_lengths[symbol])
+			{
+				const std::uint16_t left{left_symbol(pairs_data, symbol)};
+				if(offset<pairs_data.symbol_lengths[left]+1)
+					symbol=left;
+				else
+				{
+					offset-=pairs_data.symbol_lengths[left]+1;
+					symbol=right_symbol(pairs_data, symbol);
+				}
+			}
+			return left_symbol(pairs_data, symbol);
+		}
+
+		[[nodiscard]] int map_dtz_score(Table_pair& table_pair, const int file, int value, const Wdl wdl) noexcept
+		{
+			constexpr std::array<int, 5> wdl_to_map{1, 3, 0, 2, 0};
+			const Pairs_data& pairs_data{table_pair.pairs_data(Table_type::dtz, 0, file)};
+			if(pairs_data.flags & mapped_flag)
+			{
+				const std::size_t map_index{pairs_data.dtz_map_index[wdl_to_map[std::to_underlying(wdl)+2]]+static_cast<std::size_t>(value)};
+				if(pairs_data.flags & wide_flag)
+					value=read_little_endian<std::uint16_t>(table_pair.dtz.dtz_map+2*map_index);
+				else
+					value=table_pair.dtz.dtz_map[map_index];
+			}
+
+			// the tables store moves or plies, plies are returned
+			if((wdl==Wdl::win && !(pairs_data.flags & win_plies_flag))
+			|| (wdl==Wdl::loss && !(pairs_data.flags & loss_plies_flag))
+			|| wdl==Wdl::cursed_win
+			|| wdl==Wdl::blessed_loss)
+				value*=2;
+			return value+1;
+		}
+
+		// maps the position onto the generator's canonical one and decodes its value
+		[[nodiscard]] int probe_table(Table_pair& table_pair, const Table_type type, const State& state, const Wdl wdl, Probe_state& result) noexcept
+		{
+			std::array<int, max_table_pieces> squares{};
+			std::array<std::uint8_t, max_table_pieces> pieces{};
+			int size{0}, lead_pawns_count{0}, table_file{0};
+			Bitboard lead_pawns{0ULL};
+
+			// tables are generated with white as the stronger side, and symmetric ones with white to move
+			const bool is_black_symmetric{state.side_to_move==Side::black && table_pair.key==table_pair.mirrored_key},
+					   is_black_stronger{material_key(to_material(state))!=table_pair.key},
+					   is_flipped{is_black_symmetric || is_black_stronger};
+			const std::uint8_t flip_colour{static_cast<std::uint8_t>(is_flipped? 8 : 0)};
+			const int flip_squares{is_flipped? 56 : 0};
+			const int side_to_move{is_flipped^(state.side_to_move==Side::black)};
+
+			const auto pawns_less=[](const int lhs, const int rhs){ return encoding_tables.pawn_map[lhs]<encoding_tables.pawn_map[rhs]; };
+			if(table_pair.has_pawns)
+			{
+				// pawns of the table's first piece colour lead, the one nearest the edge and lowest rank picks the sub table
+				const std::uint8_t lead_piece{static_cast<std::uint8_t>(table_pair.pairs_data(type, 0, 0).pieces[0]^flip_colour)};
+				lead_pawns=state.sides[(lead_piece & 8)? Side::black : Side::white].pieces[Piece::pawn];
+				lead_pawns.for_each_piece([&](const Position& position){ squares[size++]=static_cast<int>(to_index(position))^flip_squares; });
+				lead_pawns_count=size;
+				std::swap(squares[0], *std::max_element(squares.begin(), squares.begin()+lead_pawns_count, pawns_less));
+				table_file=std::min(file_of(squares[0]), 7-file_of(squares[0]));
+			}
+
+			// dtz tables only store one side to move
+			if(type==Table_type::dtz)
+			{
+				const bool is_stored_side{(table_pair.pairs_data(type, 0, table_file).flags & side_to_move_flag)==side_to_move
+									   || (table_pair.key==table_pair.mirrored_key && !table_pair.has_pawns)};
+				if(!is_stored_side)
+				{
+					result=Probe_state::change_side_to_move;
+					return 0;
+				}
+			}
+
+			for(const auto side : all_sides)
+				for(const auto piece : all_pieces)
+				{
+					const Bitboard piece_squares{piece==Piece::pawn? state.sides[side].pieces[piece] & ~lead_pawns : state.sides[side].pieces[piece]};
+					piece_squares.for_each_piece([&](const Position& position)
+					{
+						squares[size]=static_cast<int>(to_index(position))^flip_squares;
+						pieces[size++]=to_table_piece(piece, side)^flip_colour;
+					});
+				}
+
+			const Pairs_data& pairs_data{table_pair.pairs_data(type, side_to_move, table_file)};
+
+			// order the pieces like the table does
+			for(int i{lead_pawns_count}; i<size-1; ++i)
+				for(int j{i+1}; j<size; ++j)
+					if(pairs_data.pieces[i]==pieces[j])
+					{
+						std::swap(pieces[i], pieces[j]);
+						std::swap(squares[i], squares[j]);
+						break;
+					}
+
+			if(file_of(squares[0])>3)
+				for(int i{0}; i<size; ++i)
+					squares[i]=flip_file(squares[i]);
+
+			std::uint64_t index;
+			if(table_pair.has_pawns)
+			{
+				index=encoding_tables.lead_pawn_index[lead_pawns_count][squares[0]];
+				std::stable_sort(squares.begin()+1, squares.begin()+lead_pawns_count, pawns_less);
+				for(int i{1}; i<lead_pawns_count; ++i)
+					index+=encoding_tables.binomial[i][encoding_tables.pawn_map[squares[i]]];
+			}
+			else
+			{
+				if(rank_of(squares[0])>3)
+					for(int i{0}; i<size; ++i)
+						squares[i]=flip_rank(squares[i]);
+
+				// the first leading piece off the a1-h8 diagonal goes below it
+				for(int i{0}; i<pairs_data.group_length[0]; ++i)
+				{
+					if(!off_diagonal(squares[i]))
+						continue;
+					if(off_diagonal(squares[i])>0)
+						for(int j{i}; j<size; ++j)
+							squares[j]=flip_diagonal(squares[j]);
+					break;
+				}
+
+				if(table_pair.has_unique_pieces)
+				{
+					// squares already taken by earlier pieces are skipped
+					const int adjust1{squares[1]>squares[0]},
+							  adjust2{(squares[2]>squares[0])+(squares[2]>squares[1])};
+					if(off_diagonal(squares[0]))
+						index=(encoding_tables.triangle_map[squares[0]]*63+(squares[1]-adjust1))*62+squares[2]-adjust2;
+					else if(off_diagonal(squares[1]))
+						index=(6*63+rank_of(squares[0])*28+encoding_tables.below_diagonal_map[squares[1]])*62+squares[2]-adjust2;
+					else if(off_diagonal(squares[2]))
+						index=6*63*62+4*28*62+rank_of(squares[0])*7*28+(rank_of(squares[1])-adjust1)*28+encoding_tables.below_diagonal_map[squares[2]];
+					else
+						index=6*63*62+4*28*62+4*7*28+rank_of(squares[0])*7*6+(rank_of(squares[1])-adjust1)*6+(rank_of(squares[2])-adjust2);
+				}
+				else
+					index=encoding_tables.king_pair_map[encoding_tables.triangle_map[squares[0]]][squares[1]];
+			}
+
+			// the remaining groups, each one in ascending square order
+			index*=pairs_data.group_index[0];
+			int group_start{pairs_data.group_length[0]};
+			bool has_remaining_pawns{table_pair.has_pawns && table_pair.pawn_count[1]>0};
+			for(int group{1}; pairs_data.group_length[group]; ++group)
+			{
+				const int group_length{pairs_data.group_length[group]};
+				std::stable_sort(squares.begin()+group_start, squares.begin()+group_start+group_length);
+				std::uint64_t group_index{0};
+				for(int i{0}; i<group_length; ++i)
+				{
+					const int square{squares[group_start+i]};
+					const auto adjust{std::count_if(squares.begin(), squares.begin()+group_start, [&](const int earlier_square){ return square>earlier_square; })};
+					group_index+=encoding_tables.binomial[i+1][square-adjust-(has_remaining_pawns? 8 : 0)];
+				}
+				has_remaining_pawns=false;
+				index+=group_index*pairs_data.group_index[group];
+				group_start+=group_length;
+			}
+
+			const int value{decompress_pairs(pairs_data, index)};
+			return type==Table_type::wdl? value-2 : map_dtz_score(table_pair, table_file, value, wdl);
+		}
+
+		class Prober
+		{
+			public:
+
+			Prober(const std::unordered_map<std::uint64_t, Table_pair*>& tables, State& state) noexcept
+				: tables_(tables), state_(state)
+			{
+			}
+
+			// the tables store "don't care" values where a capture or pawn move wins, so those moves are searched first
+			[[nodiscard]] Wdl search(const bool check_zeroing_moves, Probe_state& result) noexcept
+			{
+				Wdl best_value{Wdl::loss};
+				const auto moves{generate_moves<Moves_type::legal>(state_)};
+				std::size_t move_count{0};
+				for(const auto& move : moves)
+				{
+					if(!is_capture(state_, move) && (!check_zeroing_moves || !is_zeroing(state_, move)))
+						continue;
+					++move_count;
+
+					make(state_, move);
+					const Wdl value{-search(false, result)};
+					unmove(state_);
+
+					if(result==Probe_state::fail)
+						return Wdl::draw;
+					if(value>best_value)
+					{
+						best_value=value;
+						if(value>=Wdl::win)
+						{
+							result=Probe_state::zeroing_best_move;
+							return value;
+						}
+					}
+				}
+
+				// positions with en passant rights are not in the tables, but then every move has been searched
+				const bool has_no_more_moves{move_count>0 && move_count==moves.size()};
+				Wdl value{best_value};
+				if(!has_no_more_moves)
+				{
+					value=probe_wdl_table(result);
+					if(result==Probe_state::fail)
+						return Wdl::draw;
+				}
+
+				if(best_value>=value)
+				{
+					result=best_value>Wdl::draw || has_no_more_moves? Probe_state::zeroing_best_move : Probe_state::ok;
+					return best_value;
+				}
+				result=Probe_state::ok;
+				return value;
+			}
+
+			[[nodiscard]] int probe_dtz(Probe_state& result) noexcept
+			{
+				result=Probe_state::ok;
+				const Wdl wdl{search(true, result)};
+				// draws are not stored
+				if(result==Probe_state::fail || wdl==Wdl::draw)
+					return 0;
+				if(result==Probe_state::zeroing_best_move)
+					return dtz_before_zeroing(wdl);
+
+				int dtz{probe_table_type(Table_type::dtz, wdl, result)};
+				if(result==Probe_state::fail)
+					return 0;
+				if(result!=Probe_state::change_side_to_move)
+					return (dtz+100*(wdl==Wdl::blessed_loss || wdl==Wdl::cursed_win))*sign_of(std::to_underlying(wdl));
+
+				// the table stores the other side to move, so the best reply is found with a one ply search
+				int min_dtz{0xFFFF};
+				for(const auto& move : generate_moves<Moves_type::legal>(state_))
+				{
+					const bool is_zeroing_move{is_zeroing(state_, move)};
+					make(state_, move);
+
+					// for zeroing moves the dtz of the move itself is wanted, not that of the next zeroing sequence
+					dtz=is_zeroing_move? -dtz_before_zeroing(search(false, result)) : -probe_dtz(result);
+					if(dtz==1 && state_.in_check() && generate_moves<Moves_type::legal>(state_).empty())
+						min_dtz=1;
+					if(!is_zeroing_move)
+						dtz+=sign_of(dtz);
+					if(dtz<min_dtz && sign_of(dtz)==sign_of(std::to_underlying(wdl)))
+						min_dtz=dtz;
+
+					unmove(state_);
+					if(result==Probe_state::fail)
+						return 0;
+				}
+				// no legal moves is mate
+				return min_dtz==0xFFFF? -1 : min_dtz;
+			}
+
+			private:
+
+			[[nodiscard]] Wdl probe_wdl_table(Probe_state& result) noexcept
+			{
+				return static_cast<Wdl>(probe_table_type(Table_type::wdl, Wdl::draw, result));
+			}
+
+			[[nodiscard]] int probe_table_type(const Table_type type, const Wdl wdl, Probe_state& result) noexcept
+			{
+				// king against king has no table
+				if(state_.occupied_squares().popcount()==2)
+					return std::to_underlying(Wdl::draw);
+
+				const auto table_pair{tables_.find(material_key(to_material(state_)))};
+				if(table_pair==tables_.end() || !ensure_mapped(*table_pair->second, type))
+				{
+					result=Probe_state::fail;
+					return 0;
+				}
+				return probe_table(*table_pair->second, type, state_, wdl, result);
+			}
+
+			const std::unordered_map<std::uint64_t, Table_pair*>& tables_;
+			State& state_;
+		};
+	}
+
+	Tablebases::Tablebases() noexcept = default;
+	Tablebases::~Tablebases() = default;
+
+	std::size_t Tablebases::load(const std::string_view paths) noexcept
+	{
+		tables_by_material_.clear();
+		tables_.clear();
+		max_pieces_=0;
+
+#ifdef _WIN32
+		constexpr char path_separator{';'};
+#else
+		constexpr char path_separator{':'};
+#endif
+		std::unordered_map<std::string, std::size_t> table_indexes;
+		for(const auto directory_range : paths | std::views::split(path_separator))
+		{
+			const std::filesystem::path directory{std::string_view{directory_range.begin(), directory_range.end()}};
+			std::error_code error;
+			if(directory.empty() || !std::filesystem::is_directory(directory, error))
+				continue;
+
+			for(const auto& entry : std::filesystem::directory_iterator{directory, error})
+			{
+				const std::string extension{entry.path().extension().string()}, name{entry.path().stem().string()};
+				if(extension!=wdl_extension && extension!=dtz_extension)
+					continue;
+				const auto material{parse_table_name(name)};
+				if(!material)
+					continue;
+
+				if(!table_indexes.contains(name))
+				{
+					auto table_pair{std::make_unique<Table_pair>()};
+					table_pair->name=name;
+					table_pair->key=material_key(*material);
+					table_pair->mirrored_key=material_key(Material{(*material)[Side::black], (*material)[Side::white]});
+					table_pair->piece_count=0;
+					table_pair->has_unique_pieces=false;
+					for(const auto side : all_sides)
+						for(const auto piece : all_pieces)
+						{
+							table_pair->piece_count+=(*material)[side][piece];
+							if(piece!=Piece::king && (*material)[side][piece]==1)
+								table_pair->has_unique_pieces=true;
+						}
+					if(table_pair->piece_count>max_table_pieces)
+						continue;
+
+					const unsigned white_pawns{(*material)[Side::white][Piece::pawn]}, black_pawns{(*material)[Side::black][Piece::pawn]};
+					table_pair->has_pawns=white_pawns+black_pawns>0;
+					const bool does_white_lead{black_pawns==0 || (white_pawns>0 && black_pawns>=white_pawns)};
+					table_pair->pawn_count=does_white_lead? std::array{white_pawns, black_pawns} : std::array{black_pawns, white_pawns};
+
+					table_indexes.emplace(name, tables_.size());
+					tables_.push_back(std::move(table_pair));
+				}
+
+				// the first directory listing a table wins
+				Table_pair& table_pair{*tables_[table_indexes.at(name)]};
+				Table& table{extension==wdl_extension? table_pair.wdl : table_pair.dtz};
+				if(table.path.empty())
+					table.path=entry.path();
+			}
+		}
+
+		// only tables with wdl values can be probed during search
+		std::erase_if(tables_, [](const auto& table_pair){ return table_pair->wdl.path.empty(); });
+		for(const auto& table_pair : tables_)
+		{
+			tables_by_material_.emplace(table_pair->key, table_pair.get());
+			tables_by_material_.emplace(table_pair->mirrored_key, table_pair.get());
+			max_pieces_=std::max(max_pieces_, table_pair->piece_count);
+		}
+		return tables_.size();
+	}
+
+	bool Tablebases::can_probe(const State& state) const noexcept
+	{
+		// castling rights are not part of the tables
+		const bool has_castling_rights{std::ranges::any_of(all_sides, [&](const Side side)
+		{
+			return std::ranges::any_of(all_castling_rights, [&](const Castling_rights castling_right){ return state.sides[side].castling_rights[castling_right]; });
+		})};
+		return max_pieces_>0 && !has_castling_rights && state.occupied_squares().popcount()<=max_pieces_;
+	}
+
+	std::optional<Wdl> Tablebases::probe_wdl(State& state) const noexcept
+	{
+		if(!can_probe(state))
+			return std::nullopt;
+		Probe_state result{Probe_state::ok};
+		const Wdl wdl{Prober{tables_by_material_, state}.search(false, result)};
+		if(result==Probe_state::fail)
+			return std::nullopt;
+		return wdl;
+	}
+
+	std::optional<int> Tablebases::probe_dtz(State& state) const noexcept
+	{
+		if(!can_probe(state))
+			return std::nullopt;
+		Probe_state result{Probe_state::ok};
+		const int dtz{Prober{tables_by_material_, state}.probe_dtz(result)};
+		if(result==Probe_state::fail)
+			return std::nullopt;
+		return dtz;
+	}
+
+	std::optional<Fixed_capacity_vector<Move, max_legal_moves>> Tablebases::best_root_moves(State& state) const noexcept
+	{
+		if(!can_probe(state))
+			return std::nullopt;
+
+		const auto moves{generate_moves<Moves_type::legal>(state)};
+		if(moves.empty())
+			return std::nullopt;
+
+		Prober prober{tables_by_material_, state};
+		const int half_move_clock{static_cast<int>(state.half_move_clock)};
+		const bool is_repeated{has_repeated(state)};
+
+		// wins that are sure to convert rank equally, others are ranked by how close the 50 move rule is
+		const auto rank_by_dtz=[&]() -> std::optional<Fixed_capacity_vector<int, max_legal_moves>>
+		{
+			Fixed_capacity_vector<int, max_legal_moves> ranks;
+			for(const auto& move : moves)
+			{
+				Probe_state result{Probe_state::ok};
+				make(state, move);
+				int dtz;
+				if(state.half_move_clock==0)
+					dtz=dtz_before_zeroing(-prober.search(false, result));
+				else
+				{
+					dtz=-prober.probe_dtz(result);
+					dtz+=sign_of(dtz);
+				}
+				if(state.in_check() && dtz==2 && generate_moves<Moves_type::legal>(state).empty())
+					dtz=1;
+				unmove(state);
+				if(result==Probe_state::fail)
+					return std::nullopt;
+
+				ranks.push_back(dtz>0? (dtz+half_move_clock<=99 && !is_repeated? max_dtz : max_dtz-(dtz+half_move_clock))
+							  : dtz<0? (-dtz*2+half_move_clock<100? -max_dtz : -max_dtz+(-dtz+half_move_clock))
+							  : 0);
+			}
+			return ranks;
+		};
+
+		// without dtz tables the wdl values still rank wins over draws over losses
+		const auto rank_by_wdl=[&]() -> std::optional<Fixed_capacity_vector<int, max_legal_moves>>
+		{
+			constexpr std::array<int, 5> wdl_to_rank{-max_dtz, -max_dtz+101, 0, max_dtz-101, max_dtz};
+			Fixed_capacity_vector<int, max_legal_moves> ranks;
+			for(const auto& move : moves)
+			{
+				Probe_state result{Probe_state::ok};
+				make(state, move);
+				const Wdl wdl{-prober.search(false, result)};
+				unmove(state);
+				if(result==Probe_state::fail)
+					return std::nullopt;
+				ranks.push_back(wdl_to_rank[std::to_underlying(wdl)+2]);
+			}
+			return ranks;
+		};
+
+		auto ranks{rank_by_dtz()};
+		if(!ranks)
+			ranks=rank_by_wdl();
+		if(!ranks)
+			return std::nullopt;
+
+		const int best_rank{*std::ranges::max_element(*ranks)};
+		Fixed_capacity_vector<Move, max_legal_moves> best_moves;
+		for(std::size_t i{0}; i<moves.size(); ++i)
+			if(ranks->at(i)==best_rank)
+				best_moves.push_back(moves.at(i));
+		return best_moves;
+	}
+}
@@ -0,0 +1,52 @@
+#ifndef Syzygy_h_INCLUDED
+#define Syzygy_h_INCLUDED
+
+#include "Fixed_capacity_vector.h"
+#include "Move.h"
+#include "State.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace engine::syzygy
+{
+	// win/loss from the side to move's perspective, cursed and blessed results are decided by the 50 move rule
+	enum class Wdl : int
+	{
+		loss=-2, blessed_loss=-1, draw=0, cursed_win=1, win=2
+	};
+
+	struct Table_pair;
+
+	class Tablebases
+	{
+		public:
+
+		Tablebases() noexcept;
+		~Tablebases();
+
+		// paths are separated like the PATH environment variable, returns the number of tables found
+		std::size_t load(const std::string_view paths) noexcept;
+
+		[[nodiscard]] inline unsigned max_pieces() const noexcept { return max_pieces_; }
+		[[nodiscard]] bool can_probe(const State& state) const noexcept;
+
+		// the probes play moves on state and restore it before returning
+		[[nodiscard]] std::optional<Wdl> probe_wdl(State& state) const noexcept;
+		[[nodiscard]] std::optional<int> probe_dtz(State& state) const noexcept;
+		// the root moves that keep the best result reachable under the 50 move rule, nothing if a table is missing
+		[[nodiscard]] std::optional<Fixed_capacity_vector<Move, max_legal_moves>> best_root_moves(State& state) const noexcept;
+
+		private:
+
+		std::vector<std::unique_ptr<Table_pair>> tables_;
+		std::unordered_map<std::uint64_t, Table_pair*> tables_by_material_;
+		unsigned max_pieces_{0};
+	};
+}
+
+#endif // Syzygy_h_INCLUDED
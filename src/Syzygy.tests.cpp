@@ -0,0 +1,112 @@
+#include <doctest/doctest.h>
+
+#include "State.h"
+#include "Syzygy.h"
+
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+using namespace engine;
+
+TEST_SUITE("Syzygy.h")
+{
+	TEST_CASE("load()")
+	{
+		syzygy::Tablebases tablebases;
+
+		SUBCASE("no paths")
+		{
+			REQUIRE(tablebases.load("")==0);
+			REQUIRE(tablebases.max_pieces()==0);
+			REQUIRE_FALSE(tablebases.can_probe(State{"8/8/8/4k3/8/8/8/4KQ2 w - - 0 1"}));
+		}
+
+		SUBCASE("table discovery")
+		{
+			const std::filesystem::path directory{std::filesystem::temp_directory_path()/"syzygy_load_test"};
+			std::filesystem::create_directories(directory);
+			for(const auto file_name : {"KQvK.rtbw", "KQvK.rtbz", "KRvKN.rtbw", "KNvK.rtbz", "KQvQ.rtbw", "KQvK.txt"})
+				std::ofstream{directory/file_name}<<"not a table";
+
+			// dtz only tables can not be probed during search, names without both kings are not tables
+			REQUIRE(tablebases.load(directory.string())==2);
+			REQUIRE(tablebases.max_pieces()==4);
+			REQUIRE(tablebases.can_probe(State{"8/8/8/4k3/8/8/8/4KQ2 w - - 0 1"}));
+			REQUIRE_FALSE(tablebases.can_probe(State{"4k3/8/8/8/8/8/8/R3K3 w Q - 0 1"}));
+			REQUIRE_FALSE(tablebases.can_probe(State{starting_fen}));
+
+			std::filesystem::remove_all(directory);
+		}
+	}
+
+	// the tables are not part of the repository, the probes are tested when SYZYGY_PATH names a directory holding
+	// KQvK, KRvK and KBNvK with their wdl and dtz files
+	TEST_CASE("probes")
+	{
+		syzygy::Tablebases tablebases;
+		const char* const paths{std::getenv("SYZYGY_PATH")};
+		if(!paths || tablebases.load(paths)==0)
+		{
+			MESSAGE("SYZYGY_PATH has no tables, the probes are not tested");
+			return;
+		}
+
+		struct Probe_case
+		{
+			std::string_view fen;
+			syzygy::Wdl wdl;
+			int dtz;
+		};
+		// mates in one, a mated king, and a rook that can only be saved from capture by moving
+		constexpr std::array<Probe_case, 5> probe_cases
+		{{
+			{"k7/8/1K6/8/8/8/7Q/8 w - - 0 1", syzygy::Wdl::win, 1},
+			{"k6Q/8/1K6/8/8/8/8/8 b - - 0 1", syzygy::Wdl::loss, -1},
+			{"k7/8/1K6/8/8/8/8/7R w - - 0 1", syzygy::Wdl::win, 1},
+			{"8/8/8/8/8/2k5/1R6/7K b - - 0 1", syzygy::Wdl::draw, 0},
+			{"k7/3N4/1K2B3/8/8/8/8/8 w - - 0 1", syzygy::Wdl::win, 1}
+		}};
+		for(const auto& [fen, wdl, dtz] : probe_cases)
+		{
+			CAPTURE(std::string{fen});
+			State state{fen};
+			const State original_state{state};
+			const auto probed_wdl{tablebases.probe_wdl(state)};
+			const auto probed_dtz{tablebases.probe_dtz(state)};
+			if(!probed_wdl || !probed_dtz)
+			{
+				MESSAGE("a table is missing from SYZYGY_PATH");
+				continue;
+			}
+			CHECK(*probed_wdl==wdl);
+			CHECK(*probed_dtz==dtz);
+			CHECK(state==original_state);
+		}
+
+		SUBCASE("best_root_moves()")
+		{
+			// only taking the rook draws
+			State drawing_state{probe_cases[3].fen};
+			if(const auto best_moves{tablebases.best_root_moves(drawing_state)})
+			{
+				REQUIRE(best_moves->size()==1);
+				CHECK(best_moves->front()==Move{algebraic_to_position("c3"), algebraic_to_position("b2")});
+			}
+
+			// with the 50 move rule about to end the game only the mate still wins
+			State winning_state{"k7/8/1K6/8/8/8/7Q/8 w - - 99 60"};
+			if(const auto best_moves{tablebases.best_root_moves(winning_state)})
+			{
+				REQUIRE(best_moves->size()==1);
+				CHECK(best_moves->front()==Move{algebraic_to_position("h2"), algebraic_to_position("h8")});
+			}
+			// otherwise every win that converts in time ranks the same
+			State relaxed_state{probe_cases[0].fen};
+			if(const auto best_moves{tablebases.best_root_moves(relaxed_state)})
+				CHECK(best_moves->size()>1);
+		}
+	}
+}
@@ -1,5 +1,6 @@
 #include "Time_manager.h"
 
+#include <algorithm>
 #include <chrono>
 
 namespace chrono=std::chrono;
@@ -12,15 +13,47 @@ Time_manager::Time_manager(const std::optional<chrono::milliseconds>& time_on_cl
 						 , const int ply) noexcept
 	: start_time(std::chrono::steady_clock::now())
 {
+	is_time_limited=time_on_clock.has_value() || movetime.has_value();
 	if(!time_on_clock.has_value())
 	{
 		if(movetime.has_value())
 			maximum_time=optimum_time=*movetime;
 		return;
 	}
+	is_clock_managed=true;
 	int moves_to_go{movestogo==0? 30:movestogo};
 	[[maybe_unused]]chrono::milliseconds projected_time_left{std::max(chrono::milliseconds{1}, *time_on_clock+(increment-move_overhead)*moves_to_go)};
 	[[maybe_unused]]constexpr static chrono::milliseconds ms_to_reach_depth_one{4};
 	maximum_time=std::clamp(projected_time_left-(moves_to_go*ms_to_reach_depth_one), ms_to_reach_depth_one, *time_on_clock-move_overhead);
-	optimum_time=std::clamp(projected_time_left/moves_to_go, ms_to_reach_depth_one, maximum_time);
+	optimum_time=base_optimum_time=std::clamp(projected_time_left/moves_to_go, ms_to_reach_depth_one, maximum_time);
+}
+
+void Time_manager::update(const chrono::milliseconds& iteration_time, const bool best_move_changed, const int score_drop_centipawns, const double best_move_node_fraction) noexcept
+{
+	last_iteration_time=iteration_time;
+	if(!is_clock_managed)
+		return;
+
+	// a best move that keeps surviving deeper iterations is unlikely to change, a falling score or a new best move needs a closer look
+	best_move_stability=best_move_changed? 0 : best_move_stability+1;
+	const double stability_factor{best_move_changed? 1.3 : std::max(0.7, 1.1-0.1*best_move_stability)};
+	const double score_factor{std::clamp(1.0+score_drop_centipawns/100.0, 1.0, 1.5)};
+	// when the alternatives are refuted cheaply the best move is clear, when they take most of the effort it is not
+	const double effort_factor{std::clamp(1.5-best_move_node_fraction, 0.6, 1.2)};
+	optimum_time=std::min(maximum_time, chrono::duration_cast<chrono::milliseconds>(base_optimum_time*stability_factor*score_factor*effort_factor));
+}
+
+bool Time_manager::can_start_iteration() const noexcept
+{
+	if(!is_time_limited)
+		return true;
+
+	const chrono::milliseconds elapsed{used_time()};
+	// a fixed movetime is meant to be used up, the search is only stopped once it runs out
+	if(!is_clock_managed)
+		return elapsed<optimum_time;
+
+	// an unfinished iteration is thrown away, so one that is not expected to finish in time is not started
+	constexpr int estimated_branching_factor{2};
+	return elapsed<optimum_time && elapsed+last_iteration_time*estimated_branching_factor<=optimum_time;
 }
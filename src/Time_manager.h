@@ -2,6 +2,7 @@
 #define Time_manager_h_INCLUDED
 
 #include <chrono>
+#include <optional>
 
 class Time_manager
 {
@@ -14,6 +15,10 @@ class Time_manager
 						, const int movestogo
 						, const int ply) noexcept;
 
+	// best_move_node_fraction is the share of the iteration's root nodes spent on the best move
+	void update(const std::chrono::milliseconds& iteration_time, const bool best_move_changed, const int score_drop_centipawns, const double best_move_node_fraction) noexcept;
+	[[nodiscard]] bool can_start_iteration() const noexcept;
+
 	[[nodiscard]] inline std::chrono::milliseconds optimum() const noexcept { return optimum_time; }
 	[[nodiscard]] inline std::chrono::milliseconds maximum() const noexcept { return maximum_time; }
 	[[nodiscard]] inline std::chrono::milliseconds used_time() const noexcept { return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start_time); }
@@ -21,7 +26,10 @@ class Time_manager
 	private:
 
 	std::chrono::time_point<std::chrono::steady_clock> start_time;
-	std::chrono::milliseconds optimum_time, maximum_time;
+	std::chrono::milliseconds optimum_time{std::chrono::milliseconds::max()}, maximum_time{std::chrono::milliseconds::max()};
+	std::chrono::milliseconds base_optimum_time{std::chrono::milliseconds::max()}, last_iteration_time{0};
+	bool is_time_limited{false}, is_clock_managed{false};
+	int best_move_stability{0};
 };
 
 #endif // Time_manager_h_INCLUDED
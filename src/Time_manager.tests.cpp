@@ -0,0 +1,29 @@
+#include <doctest/doctest.h>
+
+#include "Time_manager.h"
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+TEST_SUITE("Time_manager.h")
+{
+	TEST_CASE("can_start_iteration()")
+	{
+		SUBCASE("a fixed movetime is used up")
+		{
+			Time_manager time_manager{std::nullopt, 10s, 0ms, 0ms, 0, 0};
+			time_manager.update(6s, false, 0, 1.0);
+			CHECK(time_manager.can_start_iteration());
+		}
+
+		SUBCASE("an iteration that cannot finish on the clock is not started")
+		{
+			Time_manager time_manager{60s, std::nullopt, 0ms, 0ms, 0, 0};
+			time_manager.update(time_manager.optimum(), false, 0, 1.0);
+			CHECK_FALSE(time_manager.can_start_iteration());
+		}
+
+		CHECK(Time_manager{std::nullopt, std::nullopt, 0ms, 0ms, 0, 0}.can_start_iteration());
+	}
+}
@@ -4,10 +4,13 @@
 #include "Constants.h"
 #include "Move.h"
 #include "Pieces.h"
+#include "Polyglot_randoms.h"
 #include "State.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
+#include <limits>
 #include <mutex>
 #include <optional>
 #include <random>
@@ -63,6 +66,30 @@ namespace zobrist
 		hash ^= zobrist_randoms.side;
 	}
 
+	// the material key hashes how many of each piece there are, so the piece randoms are indexed by count instead of square
+	inline void invert_piece_count(std::uint64_t& hash, const engine::Piece& piece, const engine::Side& side, const std::size_t count)
+	{
+		hash ^= zobrist_randoms.pieces[piece][side][count];
+	}
+
+	[[nodiscard]] inline std::uint64_t pawn_hash(const engine::State& state) noexcept
+	{
+		std::uint64_t hash{0};
+		for(const auto& side : engine::all_sides)
+			state.sides[side].pieces[engine::Piece::pawn].for_each_piece([&](const engine::Position& position){ invert_piece_at(hash, position, engine::Piece::pawn, side); });
+		return hash;
+	}
+
+	[[nodiscard]] inline std::uint64_t material_hash(const engine::State& state) noexcept
+	{
+		std::uint64_t hash{0};
+		for(const auto& side : engine::all_sides)
+			for(const auto& piece : engine::all_pieces)
+				for(std::size_t count{0}; count<state.sides[side].pieces[piece].popcount(); ++count)
+					invert_piece_count(hash, piece, side, count);
+		return hash;
+	}
+
 	[[nodiscard]] inline std::uint64_t hash(const engine::State& state) noexcept
 	{
 		std::uint64_t hash{0};
@@ -88,20 +115,71 @@ namespace zobrist
 	}
 }
 
+// the key used by Polyglot opening books, the layout of the randoms is fixed by the book format
+namespace polyglot
+{
+	// black pawn, white pawn, black knight, ..., white king
+	[[nodiscard]] constexpr std::size_t piece_kind(const engine::Piece& piece, const engine::Side& side) noexcept
+	{
+		constexpr engine::Piece_map<std::size_t> kind_pairs{5, 0, 1, 2, 3, 4};
+		return 2*kind_pairs[piece]+(side==engine::Side::white);
+	}
+
+	[[nodiscard]] inline std::uint64_t hash(const engine::State& state) noexcept
+	{
+		std::uint64_t hash{0};
+		for(const auto &[piece, position, side] : state.get_board_data())
+			hash ^= randoms[64*piece_kind(piece, side)+to_index(position)];
+
+		constexpr std::array<std::pair<engine::Side, engine::Castling_rights>, 4> castling_order
+		{{
+			{engine::Side::white, engine::Castling_rights::kingside}, {engine::Side::white, engine::Castling_rights::queenside},
+			{engine::Side::black, engine::Castling_rights::kingside}, {engine::Side::black, engine::Castling_rights::queenside}
+		}};
+		for(std::size_t index{0}; index<castling_order.size(); ++index)
+			if(state.sides[castling_order[index].first].castling_rights[castling_order[index].second])
+				hash ^= randoms[castling_offset+index];
+
+		// the en passant square only counts when a pawn can actually capture onto it
+		if(state.en_passant_target_square)
+		{
+			const engine::Position target{state.en_passant_target_square.value()};
+			const int capturing_rank{target.rank_+(state.side_to_move==engine::Side::white? -1 : 1)};
+			const auto& pawns{state.sides[state.side_to_move].pieces[engine::Piece::pawn]};
+			const bool can_capture{std::ranges::any_of(std::array{target.file_-1, target.file_+1}, [&](const int file)
+			{
+				const engine::Position square{capturing_rank, file};
+				return is_on_board(square) && pawns.is_occupied(square);
+			})};
+			if(can_capture)
+				hash ^= randoms[en_passant_offset+target.file_];
+		}
+
+		if(state.side_to_move == engine::Side::white)
+			hash ^= randoms[turn_offset];
+		return hash;
+	}
+}
+
 namespace engine
 {
-	enum class Search_result_type
+	enum class Search_result_type : std::uint8_t
 	{
 		lower_bound, upper_bound, exact, size
 	};
 
 	struct Transposition_data
 	{
+		constexpr static int no_static_evaluation{std::numeric_limits<int>::min()};
+
 		unsigned remaining_depth;
 		int eval;
 		std::uint64_t zobrist_hash;
 		Search_result_type search_result_type;
+		std::uint8_t generation;
 		engine::Move best_move;
+		// the network's evaluation before correction, so a later visit does not run the network again
+		int static_evaluation{no_static_evaluation};
 	};
 
 	class Transposition_table
@@ -121,13 +199,25 @@ namespace engine
 				return std::nullopt;
 		}
 
-		void insert(const Transposition_data& t_data)
+		// the same position is always updated, another position's entry is only replaced by a result at least as deep
+		// or once it was left by an earlier search
+		void insert(Transposition_data t_data)
 		{
 			const auto index = t_data.zobrist_hash%data.size();
 			std::shared_lock resizing_lock(tt_mtx);
 			std::lock_guard group_lock(locks[index%num_lock_groups]);
 
-			data[index] = t_data;
+			Transposition_data& entry{data[index]};
+			if(entry.zobrist_hash!=t_data.zobrist_hash && entry.generation==generation && entry.remaining_depth>t_data.remaining_depth)
+				return;
+			t_data.generation=generation;
+			entry=t_data;
+		}
+
+		// called before the search threads start, it is only read while they run
+		void new_search() noexcept
+		{
+			++generation;
 		}
 
 		void resize(int size_mb) noexcept
@@ -140,12 +230,27 @@ namespace engine
 			locks.swap(new_locks);
 		}
 
+		// permille of a sample of entries that have been written to, as reported by uci
+		[[nodiscard]] int hashfull() noexcept
+		{
+			std::shared_lock resizing_lock(tt_mtx);
+
+			const std::size_t sample_size{std::min(data.size(), std::size_t{1000})};
+			std::size_t used_entries{0};
+			for(std::size_t index{0}; index<sample_size; ++index)
+			{
+				std::shared_lock group_lock(locks[index%num_lock_groups]);
+				used_entries+=data[index].zobrist_hash!=0;
+			}
+			return sample_size==0? 0 : static_cast<int>(used_entries*1000/sample_size);
+		}
+
 		void clear() noexcept
 		{
 			std::lock_guard lock(tt_mtx);
 
 			for(auto& entry : data)
-				entry.zobrist_hash=0;
+				entry=Transposition_data{};
 		}
 
 		explicit Transposition_table(int table_size_mb)
@@ -165,6 +270,7 @@ namespace engine
 		int num_lock_groups{-1};
 		std::vector<std::shared_mutex> locks;
 		std::shared_mutex tt_mtx;
+		std::uint8_t generation{0};
 
 		constexpr static int mb_to_bytes{1024*1024};
 	};
@@ -1,5 +1,6 @@
 #include <doctest/doctest.h>
 
+#include "move_unmove.h"
 #include "State.h"
 #include "Transposition_table.h"
 
@@ -80,9 +81,33 @@ TEST_SUITE("Transposition Table")
 			const auto hash{zobrist::hash(state)};
 			REQUIRE(hash==zobrist::hash(state));
 
-			state.make(Move{Position{1, 1}, Position{3, 1}});
+			make(state, Move{Position{1, 1}, Position{3, 1}});
 			CHECK(zobrist::hash(state)!=hash);
 		}
+
+		SUBCASE("pawn_hash and material_hash follow make and unmove")
+		{
+			State state{"r3k2r/1P6/8/3pP3/8/8/8/R3K2R w KQkq d6 0 1"};
+			const auto pawn_hash{state.pawn_hash}, material_hash{state.material_hash};
+			REQUIRE(pawn_hash==zobrist::pawn_hash(state));
+			REQUIRE(material_hash==zobrist::material_hash(state));
+
+			// en passant, a capturing promotion and castling
+			const std::array moves{Move{Position{4, 4}, Position{5, 3}}, Move{Position{7, 4}, Position{6, 3}}, Move{Position{6, 1}, Position{7, 0}, Piece::queen}, Move{Position{7, 7}, Position{1, 7}}, Move{Position{0, 4}, Position{0, 6}}};
+			for(const auto& move : moves)
+			{
+				make(state, move);
+				CHECK(state.pawn_hash==zobrist::pawn_hash(state));
+				CHECK(state.material_hash==zobrist::material_hash(state));
+			}
+			CHECK(state.pawn_hash!=pawn_hash);
+			CHECK(state.material_hash!=material_hash);
+
+			for(std::size_t i{0}; i<moves.size(); ++i)
+				unmove(state);
+			CHECK(state.pawn_hash==pawn_hash);
+			CHECK(state.material_hash==material_hash);
+		}
 	}
 
 	TEST_CASE("Transposition Table")
@@ -101,5 +126,28 @@ TEST_SUITE("Transposition Table")
 			CHECK(cache_result->eval==1000.0);
 			CHECK(tt[0x234234234]==std::nullopt);
 		}
+
+		SUBCASE("deeper entries are kept until a new search")
+		{
+			Transposition_table tt(1);
+			const std::uint64_t number_of_entries{1024*1024/sizeof(Transposition_data)}, deep_hash{0x1234}, shallow_hash{deep_hash+number_of_entries};
+			tt.insert(Transposition_data{.remaining_depth=5, .eval=1, .zobrist_hash=deep_hash});
+			tt.insert(Transposition_data{.remaining_depth=0, .eval=2, .zobrist_hash=shallow_hash});
+			CHECK(tt[shallow_hash]==std::nullopt);
+			REQUIRE(tt[deep_hash].has_value());
+
+			// the same position is updated even by a shallower result
+			tt.insert(Transposition_data{.remaining_depth=3, .eval=3, .zobrist_hash=deep_hash});
+			CHECK(tt[deep_hash]->eval==3);
+			tt.insert(Transposition_data{.remaining_depth=3, .eval=4, .zobrist_hash=shallow_hash});
+			CHECK(tt[deep_hash]==std::nullopt);
+			CHECK(tt[shallow_hash]->eval==4);
+
+			tt.insert(Transposition_data{.remaining_depth=7, .eval=5, .zobrist_hash=deep_hash});
+			tt.new_search();
+			tt.insert(Transposition_data{.remaining_depth=0, .eval=6, .zobrist_hash=shallow_hash});
+			CHECK(tt[deep_hash]==std::nullopt);
+			CHECK(tt[shallow_hash]->eval==6);
+		}
 	}
 }
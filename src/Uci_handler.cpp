@@ -3,6 +3,7 @@
 
 #include "Constants.h"
 #include "move_unmove.h"
+#include "nnue/simd_kernels.h"
 #include "search.h"
 #include "State.h"
 #include "Uci_handler.h"
@@ -45,7 +46,10 @@ namespace uci
 
 	void Uci_handler::ucinewgame_handler() noexcept
 	{
-		return;
+		push_task([this](std::atomic<bool>&)
+		{
+			engine.clear_correction_histories();
+		});
 	}
 
 	void Uci_handler::position_handler(const Input_state& input_state) noexcept
@@ -54,10 +58,8 @@ namespace uci
 		{
 			engine.clear_tt();
 			engine::State state{input_state.fen};
-			// This is a hack for now in creating an empty accumulator, need a move(state, move)
-			Accumulator a{};
 			for(const auto& move : input_state.continuation)
-				make(state, a, move, engine.neural_network);
+				make(state, move);
 			engine.set_state(state);
 		});
 	}
@@ -68,15 +70,23 @@ namespace uci
 		{
 			engine::Search_options search_options {
 				.depth=go_options.depth,
+				.nodes=go_options.nodes,
+				.mate=go_options.mate,
+				.infinite=go_options.infinite,
+				.searchmoves=go_options.searchmoves,
 				.movestogo=go_options.movestogo,
 				.time=go_options.time,
 				.increment=go_options.increment,
 				.movetime=go_options.movetime,
 				.move_overhead=options.move_overhead,
-				.threads=options.threads
+				.threads=options.threads,
+				.multipv=options.multipv
 			};
 			const auto search_results=engine.generate_best_move(stop_token, search_options);
-			if(search_results.has_value())
+			// mate and stalemate leave no move to play
+			if(search_results.has_value() && search_results->pv.empty())
+				io.output("bestmove 0000");
+			else if(search_results.has_value())
 				io.output("bestmove ", search_results->pv.front());
 			else if(search_results.error()==engine::search_stopped{})
 				return;
@@ -92,6 +102,12 @@ namespace uci
 		io.output("option name Hash type spin default 16 min 1 max 33554432");
 		io.output(std::format("option name Threads type spin default {} min 1 max 1024", engine::default_threads));
 		io.output("option name Move Overhead type spin default 10 min 0 max 5000");
+		io.output(std::format("option name MultiPV type spin default {} min 1 max {}", engine::default_multipv, max_multipv));
+		io.output("option name SyzygyPath type string default <empty>");
+		io.output("option name Book type string default <empty>");
+		io.output("option name EvalFile type string default <embedded>");
+		io.output(std::format("info string {}", engine.neural_network.load_report()));
+		io.output(std::format("info string using {} kernels", simd_kernels::kernels().level));
 		io.output("uciok");
 	}
 
@@ -119,6 +135,39 @@ namespace uci
 			else
 				io.output("In setoption name 'Move Overhead': value out of range");
 		}
+		else if(uci_option.name=="MultiPV")
+		{
+			if(int multipv{std::stoi(uci_option.value)}; multipv>0 && static_cast<unsigned>(multipv)<=max_multipv)
+				options.multipv=multipv;
+			else
+				io.output("In setoption name 'MultiPV': value out of range");
+		}
+		else if(uci_option.name=="SyzygyPath")
+		{
+			// queued so that the tables never change under a running search
+			push_task([this, paths=uci_option.value=="<empty>"? std::string{} : uci_option.value](std::atomic<bool>&)
+			{
+				io.output(std::format("info string found {} tablebases", engine.load_tablebases(paths)));
+			});
+		}
+		else if(uci_option.name=="Book")
+		{
+			push_task([this, path=uci_option.value=="<empty>"? std::string{} : uci_option.value](std::atomic<bool>&)
+			{
+				if(!engine.open_book(path) && !path.empty())
+					io.output(std::format("info string could not open book {}", path));
+			});
+		}
+		else if(uci_option.name=="EvalFile")
+		{
+			push_task([this, path=uci_option.value=="<embedded>" || uci_option.value=="<empty>"? std::string{} : uci_option.value](std::atomic<bool>&)
+			{
+				if(const auto loaded{engine.load_network(path)})
+					io.output(std::format("info string {}", engine.neural_network.load_report()));
+				else
+					io.output(std::format("info string could not load net: {}", loaded.error()));
+			});
+		}
 		else
 			io.output("Option not found");
 	}
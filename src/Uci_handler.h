@@ -9,6 +9,7 @@
 #include <condition_variable>
 #include <functional>
 #include <queue>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -23,6 +24,10 @@ namespace uci
 	struct Go_options
 	{
 		std::optional<unsigned> depth{std::nullopt};
+		std::optional<std::uint64_t> nodes{std::nullopt};
+		std::optional<unsigned> mate{std::nullopt};
+		bool infinite{false};
+		std::vector<engine::Move> searchmoves;
 		unsigned movestogo{0};
 		engine::Side_map<std::optional<std::chrono::milliseconds>> time{std::nullopt, std::nullopt};
 		engine::Side_map<std::chrono::milliseconds> increment{std::chrono::milliseconds{0}, std::chrono::milliseconds{0}};
@@ -33,6 +38,7 @@ namespace uci
 	{
 		int threads{engine::default_threads};
 		std::chrono::milliseconds move_overhead{engine::default_move_overhead};
+		unsigned multipv{engine::default_multipv};
 	};
 
 	struct Uci_option
@@ -96,6 +102,13 @@ namespace uci
 		Uci_options options{};
 		Stdio io;
 
+		// a move in long algebraic notation, like e2e4 or e7e8q
+		[[nodiscard]] static constexpr bool is_move(const std::string_view word) noexcept
+		{
+			const auto is_square=[&](const std::size_t index){ return word[index]>='a' && word[index]<='h' && word[index+1]>='1' && word[index+1]<='8'; };
+			return (word.size()==4 || (word.size()==5 && std::string_view{"nbrq"}.contains(word[4]))) && is_square(0) && is_square(2);
+		}
+
 		friend inline std::istream& operator>>(std::istream& is, Uci_option& engine_options)
 		{
 			std::string ignore;
@@ -108,7 +121,8 @@ namespace uci
 			}
 			if(!is)
 				throw std::invalid_argument{"Option not found"};
-			return is>>engine_options.value;
+			// paths may contain spaces, so the value is the rest of the line
+			return std::getline(is>>std::ws, engine_options.value);
 		}
 
 		friend inline std::istream& operator>>(std::istream& is, Input_state& input_state)
@@ -172,6 +186,36 @@ namespace uci
 					go_options.increment[engine::Side::black]=Uci_handler::read_time(is);
 				else if(option=="movestogo")
 					is>>go_options.movestogo;
+				else if(option=="nodes")
+				{
+					std::uint64_t nodes;
+					is>>nodes;
+					go_options.nodes=nodes;
+				}
+				else if(option=="mate")
+				{
+					unsigned mate;
+					is>>mate;
+					go_options.mate=mate;
+				}
+				else if(option=="infinite")
+					go_options.infinite=true;
+				else if(option=="searchmoves")
+				{
+					// the move list has no terminator, so stop at the first word that is not a move
+					for(auto word_start{is.tellg()}; is>>option; word_start=is.tellg())
+					{
+						if(!is_move(option))
+						{
+							is.seekg(word_start);
+							break;
+						}
+						std::istringstream move_stream{option};
+						engine::Move move;
+						move_stream>>move;
+						go_options.searchmoves.push_back(move);
+					}
+				}
 				else
 					throw std::invalid_argument{"Command not found"};
 			}
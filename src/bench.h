@@ -9,7 +9,7 @@
 #include <string_view>
 #include <vector>
 
-inline unsigned benchmark(std::optional<std::size_t> number_of_positions_to_test=std::nullopt)
+inline std::uint64_t benchmark(std::optional<std::size_t> number_of_positions_to_test=std::nullopt)
 {
 
 	// https://github.com/official-stockfish/Stockfish/blob/master/src/benchmark.cpp
@@ -63,7 +63,7 @@ inline unsigned benchmark(std::optional<std::size_t> number_of_positions_to_test
 		"8/8/8/8/8/6k1/6p1/6K1 w - - 0 1",
 		"7k/7P/6K1/8/3B4/8/8/8 b - - 0 1"
 	};
-	unsigned total_nodes{0};
+	std::uint64_t total_nodes{0};
 	engine::Search_options options;
 	options.depth=10;
 	engine::Engine engine;
@@ -0,0 +1,97 @@
+#ifndef eval_batch_h_INCLUDED
+#define eval_batch_h_INCLUDED
+
+#include "nnue/Accumulator.h"
+#include "nnue/Neural_network.h"
+#include "State.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include <istream>
+#include <optional>
+#include <print>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// evaluates the valid fens among lines in batches, the rest keep no evaluation
+inline void evaluate_fen_lines(std::span<const std::string> lines, const Neural_network& neural_network, std::span<std::optional<int>> evaluations)
+{
+	std::vector<Accumulator> accumulators(Neural_network::max_batch_size);
+	std::vector<Neural_network::Batch_entry> batch;
+	std::vector<std::size_t> line_indexes;
+	std::vector<int> batch_evaluations(Neural_network::max_batch_size);
+	const auto evaluate_batch=[&]
+	{
+		neural_network.evaluate(batch, std::span{batch_evaluations}.first(batch.size()));
+		for(std::size_t index{0}; index<batch.size(); ++index)
+			evaluations[line_indexes[index]]=batch_evaluations[index];
+		batch.clear();
+		line_indexes.clear();
+	};
+
+	for(std::size_t line_index{0}; line_index<lines.size(); ++line_index)
+	{
+		if(!engine::State::is_valid_fen(lines[line_index]))
+			continue;
+		const engine::State state{lines[line_index]};
+		Accumulator& accumulator{accumulators[batch.size()]};
+		accumulator=fresh_accumulator(state, neural_network);
+		batch.push_back({state.side_to_move, state.occupied_squares().popcount(), &accumulator});
+		line_indexes.push_back(line_index);
+		if(batch.size()==Neural_network::max_batch_size)
+			evaluate_batch();
+	}
+	if(!batch.empty())
+		evaluate_batch();
+}
+
+// reads one fen per line and writes "fen;evaluation" for each in the same order, the evaluation is the net's
+// static evaluation for the side to move, invalid lines are reported on stderr and skipped
+inline void evaluate_fens(std::istream& fens, const Neural_network& neural_network, const unsigned number_of_threads)
+{
+	// the threads share a chunk of lines, which is written before the next one is read
+	constexpr std::size_t chunk_size{1<<16};
+	std::vector<std::string> lines;
+	std::vector<std::optional<int>> evaluations;
+	std::string output;
+	for(std::size_t first_line_number{1}; fens; first_line_number+=lines.size())
+	{
+		lines.clear();
+		for(std::string line; lines.size()<chunk_size && std::getline(fens, line);)
+		{
+			if(line.ends_with('\r'))
+				line.pop_back();
+			lines.push_back(line);
+		}
+		evaluations.assign(lines.size(), std::nullopt);
+
+		{
+			const std::size_t lines_per_thread{std::max<std::size_t>((lines.size()+number_of_threads-1)/number_of_threads, 1)};
+			std::vector<std::jthread> threads;
+			for(std::size_t first{0}; first<lines.size(); first+=lines_per_thread)
+			{
+				const std::size_t count{std::min(lines_per_thread, lines.size()-first)};
+				threads.emplace_back([&, first, count]
+				{
+					evaluate_fen_lines(std::span{lines}.subspan(first, count), neural_network, std::span{evaluations}.subspan(first, count));
+				});
+			}
+		}
+
+		output.clear();
+		for(std::size_t index{0}; index<lines.size(); ++index)
+		{
+			if(evaluations[index])
+				output+=std::format("{};{}\n", lines[index], *evaluations[index]);
+			else if(!lines[index].empty())
+				std::println(stderr, "invalid fen on line {}: {}", first_line_number+index, lines[index]);
+		}
+		std::print("{}", output);
+	}
+}
+
+#endif // eval_batch_h_INCLUDED
@@ -1,7 +1,12 @@
 #include "bench.h"
+#include "eval_batch.h"
+#include "nnue/simd_kernels.h"
 #include "Uci_handler.h"
 
+#include <fstream>
+#include <iostream>
 #include <print>
+#include <thread>
 
 int main(int argc, const char* argv[])
 {
@@ -13,12 +18,36 @@ int main(int argc, const char* argv[])
 			if(argc>2)
 				number_of_positions_to_test=std::atoi(argv[2]);
 			const auto start_time{std::chrono::steady_clock::now()};
-			const unsigned total_nodes{benchmark(number_of_positions_to_test)};
+			const std::uint64_t total_nodes{benchmark(number_of_positions_to_test)};
 			const auto used_time{std::chrono::steady_clock::now()-start_time};
 			std::println("===========================");
 			std::println("Total time (ms) : {}", std::chrono::duration_cast<std::chrono::milliseconds>(used_time));
 			std::println("Nodes searched  : {}", total_nodes);
 			std::println("Nodes/second    : {:.0f}", total_nodes/std::chrono::duration<double>(used_time).count());
+			std::println("SIMD kernels    : {}", simd_kernels::kernels().level);
+		}
+		else if(std::string_view{argv[1]}=="eval-batch")
+		{
+			// eval-batch [fen file, - or nothing for stdin] [threads] [net file]
+			const auto neural_network{argc>4? Neural_network::load_from_file(argv[4]) : Neural_network::load_default()};
+			if(!neural_network)
+			{
+				std::println(stderr, "could not load net: {}", neural_network.error());
+				return 1;
+			}
+			const unsigned number_of_threads{argc>3? static_cast<unsigned>(std::max(std::atoi(argv[3]), 1)) : std::max(std::thread::hardware_concurrency(), 1u)};
+			if(argc>2 && std::string_view{argv[2]}!="-")
+			{
+				std::ifstream fens{argv[2]};
+				if(!fens)
+				{
+					std::println(stderr, "could not open {}", argv[2]);
+					return 1;
+				}
+				evaluate_fens(fens, *neural_network, number_of_threads);
+			}
+			else
+				evaluate_fens(std::cin, *neural_network, number_of_threads);
 		}
 		else
 		{
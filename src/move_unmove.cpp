@@ -8,7 +8,9 @@
 
 namespace engine
 {
-	void make(State& state, Accumulator& accumulator, const Move& move, const Neural_network& neural_network) noexcept
+	// features_changed receives the features removed and added for each perspective
+	template <typename Features_changed>
+	static void make_move(State& state, const Move& move, const Features_changed& features_changed) noexcept
 	{
 		Side_position& side{state.sides[state.side_to_move]};
 		const Side enemy_side{other_side(state.side_to_move)};
@@ -19,7 +21,7 @@ namespace engine
 		const auto back_rank{state.side_to_move == Side::white? 0 : 7};
 		const auto white_old_castling_rights{state.sides[Side::white].castling_rights};
 		const auto black_old_castling_rights{state.sides[Side::black].castling_rights};
-		const auto old_zobrist_hash{state.zobrist_hash};
+		const auto old_zobrist_hash{state.zobrist_hash}, old_pawn_hash{state.pawn_hash}, old_material_hash{state.material_hash};
 		const Piece piece_type{*state.piece_at(from_square, state.side_to_move)};
 
 		Side_map<Fixed_capacity_vector<std::uint16_t,4>> added_features;
@@ -34,9 +36,18 @@ namespace engine
 			return king_squares;
 		}();
 
+		// call after the piece is removed, the count it leaves behind is the one hashed
+		const auto remove_pawn_and_material = [&](const Position& square, const Piece piece, const Side piece_side)
+		{
+			if(piece==Piece::pawn)
+				zobrist::invert_piece_at(state.pawn_hash, square, Piece::pawn, piece_side);
+			zobrist::invert_piece_count(state.material_hash, piece, piece_side, state.sides[piece_side].pieces[piece].popcount());
+		};
+
 		const auto handle_capture = [&, enemy_back_rank=state.side_to_move == Side::white? 7 : 0, enemy_side]()
 		{
 			opposite_side.pieces[piece_to_capture.value()].remove_piece(destination_square);
+			remove_pawn_and_material(destination_square, piece_to_capture.value(), enemy_side);
 			for(const auto side : all_sides)
 				removed_features[side].push_back(Neural_network::compute_feature_index(piece_to_capture.value(), destination_square, king_squares[side], enemy_side, side));
 			zobrist::invert_piece_at(state.zobrist_hash, destination_square, piece_to_capture.value(), other_side(state.side_to_move));
@@ -58,16 +69,21 @@ namespace engine
 		const auto move_and_hash = [&](const Position& from_square, const Position& destination_square, const Piece& piece_type_to_move)
 		{
 			state.sides[state.side_to_move].pieces[piece_type_to_move].move_piece(from_square, destination_square);
-			if(piece_type_to_move!=Piece::king)
+			for(const auto side : all_sides)
 			{
-				for(const auto side : all_sides)
-				{
-					removed_features[side].push_back(Neural_network::compute_feature_index(piece_type_to_move, from_square, king_squares[side], state.side_to_move, side));
-					added_features[side].push_back(Neural_network::compute_feature_index(piece_type_to_move, destination_square, king_squares[side], state.side_to_move, side));
-				}
+				// the perspective of a king that moves is refreshed instead
+				if(piece_type_to_move==Piece::king && (!Neural_network::king_is_feature || side==state.side_to_move))
+					continue;
+				removed_features[side].push_back(Neural_network::compute_feature_index(piece_type_to_move, from_square, king_squares[side], state.side_to_move, side));
+				added_features[side].push_back(Neural_network::compute_feature_index(piece_type_to_move, destination_square, king_squares[side], state.side_to_move, side));
 			}
 			zobrist::invert_piece_at(state.zobrist_hash, from_square, piece_type_to_move, state.side_to_move);
 			zobrist::invert_piece_at(state.zobrist_hash, destination_square, piece_type_to_move, state.side_to_move);
+			if(piece_type_to_move==Piece::pawn)
+			{
+				zobrist::invert_piece_at(state.pawn_hash, from_square, Piece::pawn, state.side_to_move);
+				zobrist::invert_piece_at(state.pawn_hash, destination_square, Piece::pawn, state.side_to_move);
+			}
 		};
 
 		const auto handle_castling = [&]()
@@ -111,6 +127,8 @@ namespace engine
 			const auto promotion_piece = move.promotion_piece();
 			side.pieces[Piece::pawn].remove_piece(from_square);
 			zobrist::invert_piece_at(state.zobrist_hash, from_square, Piece::pawn, state.side_to_move);
+			remove_pawn_and_material(from_square, Piece::pawn, state.side_to_move);
+			zobrist::invert_piece_count(state.material_hash, promotion_piece, state.side_to_move, side.pieces[promotion_piece].popcount());
 			side.pieces[promotion_piece].add_piece(destination_square);
 			zobrist::invert_piece_at(state.zobrist_hash, destination_square, promotion_piece, state.side_to_move);
 			for(const auto side : all_sides)
@@ -133,6 +151,7 @@ namespace engine
 			{
 				const Position capture_square{destination_square.rank_-pawn_direction, destination_square.file_};
 				opposite_side.pieces[Piece::pawn].remove_piece(capture_square);
+				remove_pawn_and_material(capture_square, Piece::pawn, enemy_side);
 				for(const auto side : all_sides)
 					removed_features[side].push_back(Neural_network::compute_feature_index(Piece::pawn, capture_square, king_squares[side], enemy_side, side));
 				zobrist::invert_piece_at(state.zobrist_hash, capture_square, Piece::pawn, other_side(state.side_to_move));
@@ -150,11 +169,13 @@ namespace engine
 			is_en_passant,
 			white_old_castling_rights,
 			black_old_castling_rights,
-			old_zobrist_hash, 
+			old_zobrist_hash,
+			old_pawn_hash,
+			old_material_hash,
 			state.half_move_clock
 		);
 
-		change_accumulator(state, removed_features, added_features, state.side_to_move, piece_type, neural_network, accumulator);
+		features_changed(removed_features, added_features, state.side_to_move, piece_type);
 
 		if(piece_type == Piece::rook || piece_type == Piece::king)
 		{
@@ -182,37 +203,23 @@ namespace engine
 		state.repetition_history.push_back(state.zobrist_hash);
 	}
 
-	void unmove(State& state, Accumulator& accumulator, const Neural_network& neural_network) noexcept
+	static void unmake_move(State& state) noexcept
 	{
 		const bool was_whites_move = state.side_to_move == Side::black;
 		const auto last_moved_side = was_whites_move? Side::white : Side::black;
 		const auto promotion_rank = was_whites_move? 7 : 0;	
 		const auto history_data = std::move(state.history.top());
 		state.history.pop();
-		const Side_map<Position> king_squares=[&]()
-		{
-			Side_map<Position> king_squares;
-			for(const auto side : all_sides)
-				king_squares[side]=state.sides[side].pieces[Piece::king].lsb_square();
-			return king_squares;
-		}();
 		state.half_move_clock=history_data.half_move_clock;
 		if(!was_whites_move)
 			--state.full_move_clock;
 		Side_position& side_to_unmove = state.sides[last_moved_side];
 		Side_position& current_side_to_move = state.sides[state.side_to_move];
-		Side_map<Fixed_capacity_vector<std::uint16_t,4>> added_features;
-		Side_map<Fixed_capacity_vector<std::uint16_t,4>> removed_features;
 		const Position& previous_move_destination = history_data.move.destination_square(), previous_move_origin = history_data.move.from_square();
 		if(history_data.piece == Piece::pawn && previous_move_destination.rank_ == promotion_rank)
 		{
 			side_to_unmove.pieces[history_data.move.promotion_piece()].remove_piece(previous_move_destination);
 			side_to_unmove.pieces[Piece::pawn].add_piece(previous_move_origin);
-			for(const auto side : all_sides)
-			{
-				removed_features[side].push_back(Neural_network::compute_feature_index(history_data.move.promotion_piece(), previous_move_destination, king_squares[side], last_moved_side, side));
-				added_features[side].push_back(Neural_network::compute_feature_index(Piece::pawn, previous_move_origin, king_squares[side], last_moved_side, side));
-			}
 		}
 		else if(history_data.piece == Piece::king && std::abs(previous_move_destination.file_ - previous_move_origin.file_) > 1)
 		{
@@ -231,9 +238,6 @@ namespace engine
 			}
 			side_to_unmove.pieces[Piece::king].move_piece(previous_move_destination, previous_move_origin);
 			side_to_unmove.pieces[Piece::rook].move_piece(rook_destination_square, rook_origin_square);
-			// refresh for the last_moved_side so only update side_to_move
-			removed_features[state.side_to_move].push_back(Neural_network::compute_feature_index(Piece::rook, rook_destination_square, king_squares[state.side_to_move], last_moved_side, state.side_to_move));
-			added_features[state.side_to_move].push_back(Neural_network::compute_feature_index(Piece::rook, rook_origin_square, king_squares[state.side_to_move], last_moved_side, state.side_to_move));
 		}
 		else
 		{
@@ -242,28 +246,12 @@ namespace engine
 				const auto direction = was_whites_move? 1:-1;
 				const Position pawn_to_return{previous_move_destination.rank_-direction, previous_move_destination.file_};
 				current_side_to_move.pieces[Piece::pawn].add_piece(pawn_to_return);
-				for(const auto side : all_sides)
-					added_features[side].push_back(Neural_network::compute_feature_index(Piece::pawn, pawn_to_return, king_squares[side], last_moved_side, side));
 			}
 			side_to_unmove.pieces[history_data.piece].move_piece(previous_move_destination, previous_move_origin);
-			if(history_data.piece!=Piece::king)
-			{
-				for(const auto side : all_sides)
-				{
-					added_features[side].push_back(Neural_network::compute_feature_index(history_data.piece, previous_move_origin, king_squares[side], last_moved_side, side));
-					removed_features[side].push_back(Neural_network::compute_feature_index(history_data.piece, previous_move_destination, king_squares[side], last_moved_side, side));
-				}
-			}
 		}
 
 		if(history_data.captured_piece)
-		{
 			current_side_to_move.pieces[*history_data.captured_piece].add_piece(previous_move_destination);
-			for(const auto side : all_sides)
-				added_features[side].push_back(Neural_network::compute_feature_index(*history_data.captured_piece, previous_move_destination, king_squares[side], state.side_to_move, side));
-		}
-
-		change_accumulator(state, removed_features, added_features, last_moved_side, history_data.piece, neural_network, accumulator);
 
 		state.sides[Side::white].castling_rights=history_data.white_castling_rights;
 		state.sides[Side::black].castling_rights=history_data.black_castling_rights;
@@ -275,5 +263,31 @@ namespace engine
 
 		state.repetition_history.pop_back();
 		state.zobrist_hash = history_data.previous_zobrist_hash;
+		state.pawn_hash = history_data.previous_pawn_hash;
+		state.material_hash = history_data.previous_material_hash;
+	}
+
+	void make(State& state, Accumulator_stack& accumulators, const Move& move) noexcept
+	{
+		make_move(state, move, [&](const auto& removed_features, const auto& added_features, const Side side, const Piece piece)
+		{
+			accumulators.push(removed_features, added_features, side, piece);
+		});
+	}
+
+	void make(State& state, const Move& move) noexcept
+	{
+		make_move(state, move, [](const auto&...){});
+	}
+
+	void unmove(State& state, Accumulator_stack& accumulators) noexcept
+	{
+		accumulators.pop();
+		unmake_move(state);
+	}
+
+	void unmove(State& state) noexcept
+	{
+		unmake_move(state);
 	}
 }
@@ -3,16 +3,17 @@
 
 #include "nnue/Accumulator.h"
 #include "Move.h"
-#include "nnue/Neural_network.h"
 #include "State.h"
 
 namespace engine
 {
-	void make(State& state, Accumulator& accumulator, const Move& move, const Neural_network& neural_network) noexcept;
-	// void make(State& state, const Move& move) noexcept;
+	// records the changed features on the stack, the accumulator itself is only computed when it is evaluated
+	void make(State& state, Accumulator_stack& accumulators, const Move& move) noexcept;
+	// keeps no accumulator, for tools that only replay positions
+	void make(State& state, const Move& move) noexcept;
 
-	void unmove(State& state, Accumulator& accumulator, const Neural_network& neural_network) noexcept;
-	// void unmove(State& state) noexcept;
+	void unmove(State& state, Accumulator_stack& accumulators) noexcept;
+	void unmove(State& state) noexcept;
 }
 
 #endif // move_unmove_h_INCLUDED
@@ -2,14 +2,17 @@
 #define Accumulator_h_INCLUDED
 
 #include "../Constants.h"
-#include "layers/Feature_transformer.h"
+#include "../Fixed_capacity_vector.h"
 #include "Neural_network.h"
 #include "../State.h"
 
+#include <array>
 #include <cstdint>
 #include <span>
+#include <utility>
+#include <vector>
 
-using Accumulator=engine::Side_map<std::array<std::int16_t, Feature_transformer::dimensions.neurons>>;
+using Accumulator=Neural_network::Accumulator;
 
 inline void refresh_accumulator(std::span<const std::uint16_t> features
 					   , const engine::Side side
@@ -23,35 +26,139 @@ inline Accumulator fresh_accumulator(const engine::State& state, const Neural_ne
 {
 	Accumulator accumulator{};
 	for(const auto side : engine::all_sides)
-		refresh_accumulator(state.to_halfKP_features(side), side, neural_network, accumulator);
+		refresh_accumulator(state.to_features(side), side, neural_network, accumulator);
 	return accumulator;
 }
 
-inline void update_accumulator(std::span<const std::uint16_t> removed_features
-							 , std::span<const std::uint16_t> added_features
-							 , const engine::Side perspective
-							 , const Neural_network& neural_network
-							 , Accumulator& accumulator) noexcept
+// the accumulator last refreshed for each king square and perspective with the pieces it was built from,
+// a king move then only applies the pieces that differ from the cached board
+class Refresh_cache
 {
-	auto& side_accumulator{accumulator[perspective]};
-	neural_network.adjust_accumulator(removed_features, std::minus<>{}, side_accumulator);
-	neural_network.adjust_accumulator(added_features, std::plus<>{}, side_accumulator);
-}
+	public:
+
+	explicit Refresh_cache(const Neural_network& neural_network)
+		: entries_(2*engine::board_size*engine::board_size)
+	{
+		for(auto& entry : entries_)
+			neural_network.transform_features({}, entry.accumulator);
+	}
+
+	void refresh(const engine::State& state, const engine::Side perspective, const Neural_network& neural_network, Accumulator& accumulator) noexcept
+	{
+		const engine::Position king_square{state.sides[perspective].pieces[engine::Piece::king].lsb_square()};
+		Entry& entry{entries_[std::to_underlying(perspective)*engine::board_size*engine::board_size+to_index(king_square)]};
+		Fixed_capacity_vector<std::uint16_t, 32> removed_features, added_features;
+		for(const auto side : engine::all_sides)
+		{
+			for(const auto piece : engine::all_pieces)
+			{
+				if(piece==engine::Piece::king && !Neural_network::king_is_feature)
+					continue;
+				const engine::Bitboard current{state.sides[side].pieces[piece]};
+				engine::Bitboard& cached{entry.pieces[side][piece]};
+				(cached & ~current).for_each_piece([&](const engine::Position& square)
+				{
+					removed_features.push_back(Neural_network::compute_feature_index(piece, square, king_square, side, perspective));
+				});
+				(current & ~cached).for_each_piece([&](const engine::Position& square)
+				{
+					added_features.push_back(Neural_network::compute_feature_index(piece, square, king_square, side, perspective));
+				});
+				cached=current;
+			}
+		}
+		neural_network.adjust_accumulator(entry.accumulator, removed_features, added_features, entry.accumulator);
+		accumulator[perspective]=entry.accumulator;
+	}
+
+	private:
 
-inline void change_accumulator(const engine::State& state
-					  , const auto& removed_features
-					  , const auto& added_features
-					  , const engine::Side moved_side
-					  , const engine::Piece moved_piece
-					  , const Neural_network& neural_network
-					  , Accumulator& accumulator) noexcept
+	struct Entry
+	{
+		std::array<std::int16_t, Neural_network::transformed_neurons> accumulator;
+		engine::Side_map<Enum_map<engine::Piece, engine::Bitboard, engine::number_of_pieces>> pieces{};
+	};
+
+	std::vector<Entry> entries_;
+};
+
+// one accumulator per ply, making a move only records the features it changes and the accumulator is brought
+// up to date from the nearest computed ancestor once the position is evaluated, unmaking a move just pops it
+class Accumulator_stack
 {
-	const engine::Side enemy_side{other_side(moved_side)};
-	update_accumulator(removed_features[enemy_side], added_features[enemy_side], enemy_side, neural_network, accumulator);
-	if(moved_piece==engine::Piece::king)
-		refresh_accumulator(state.to_halfKP_features(moved_side), moved_side, neural_network, accumulator);
-	else
-		update_accumulator(removed_features[moved_side], added_features[moved_side], moved_side, neural_network, accumulator);
-}
+	public:
+
+	using Features=engine::Side_map<Fixed_capacity_vector<std::uint16_t, 4>>;
+
+	// the search stays within max_depth plies plus a few unreduced checks and a quiescence search bounded by the
+	// material on the board, like its principal variations, which hold 256 moves
+	constexpr static std::size_t max_plies{256};
+
+	Accumulator_stack(const engine::State& state, const Neural_network& neural_network)
+		: entries_(1)
+		, refresh_cache_(neural_network)
+	{
+		// making a move must not allocate
+		entries_.reserve(max_plies+1);
+		entries_.front().accumulator=fresh_accumulator(state, neural_network);
+		for(const auto side : engine::all_sides)
+			entries_.front().is_computed[side]=true;
+	}
+
+	void push(const Features& removed_features, const Features& added_features, const engine::Side moved_side, const engine::Piece moved_piece) noexcept
+	{
+		if(++top_==entries_.size())
+			entries_.emplace_back();
+		Entry& entry{entries_[top_]};
+		entry.removed_features=removed_features;
+		entry.added_features=added_features;
+		for(const auto side : engine::all_sides)
+		{
+			entry.is_computed[side]=false;
+			// the king is part of every feature of its own perspective
+			entry.needs_refresh[side]=moved_piece==engine::Piece::king && side==moved_side;
+		}
+	}
+
+	void pop() noexcept { --top_; }
+
+	[[nodiscard]] const Accumulator& current(const engine::State& state, const Neural_network& neural_network) noexcept
+	{
+		for(const auto perspective : engine::all_sides)
+		{
+			std::size_t source{top_};
+			while(!entries_[source].is_computed[perspective] && !entries_[source].needs_refresh[perspective])
+				--source;
+			// a king move in between leaves nothing to update from
+			if(!entries_[source].is_computed[perspective])
+			{
+				refresh_cache_.refresh(state, perspective, neural_network, entries_[top_].accumulator);
+				entries_[top_].is_computed[perspective]=true;
+				continue;
+			}
+			// the plies in between are computed too, their other children can start from them
+			for(std::size_t index{source+1}; index<=top_; ++index)
+			{
+				Entry& entry{entries_[index]};
+				neural_network.adjust_accumulator(entries_[index-1].accumulator[perspective], entry.removed_features[perspective], entry.added_features[perspective], entry.accumulator[perspective]);
+				entry.is_computed[perspective]=true;
+			}
+		}
+		return entries_[top_].accumulator;
+	}
+
+	private:
+
+	struct Entry
+	{
+		Accumulator accumulator;
+		Features removed_features, added_features;
+		engine::Side_map<bool> is_computed{}, needs_refresh{};
+	};
+
+	std::vector<Entry> entries_;
+	std::size_t top_{0};
+	Refresh_cache refresh_cache_;
+};
 
 #endif // Accumulator_h_INCLUDED
@@ -0,0 +1,59 @@
+#ifndef Architecture_h_INCLUDED
+#define Architecture_h_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <format>
+#include <string>
+
+#include "common.h"
+#include "feature_sets.h"
+#include "simd_kernels.h"
+
+// the topology of a net: the feature set, the neurons per perspective of the feature transformer and the dense
+// layers after it, which are repeated once per layer stack
+template <typename feature_set_type, std::size_t transformed_neurons, std::size_t layer_stacks_count, Dimensions... layer_dimensions>
+struct Architecture
+{
+	using feature_set=feature_set_type;
+
+	constexpr static Dimensions transformer_dimensions{feature_set::dimensions, transformed_neurons};
+	constexpr static std::size_t layer_stacks{layer_stacks_count};
+	constexpr static std::array<Dimensions, sizeof...(layer_dimensions)> layers{layer_dimensions...};
+
+	static_assert(feature_set::dimensions<=UINT16_MAX+1, "feature indexes are 16 bit");
+	static_assert(layer_stacks>0 && !layers.empty());
+	static_assert(layers.front().features==2*transformed_neurons, "both perspectives feed the first layer");
+	static_assert(layers.back().neurons==1, "the last layer gives the evaluation");
+	static_assert(std::ranges::all_of(layers, [](const Dimensions& layer){ return layer.features<=simd_kernels::max_dense_features; }));
+	static_assert(std::ranges::adjacent_find(layers, [](const Dimensions& layer, const Dimensions& next_layer){ return layer.neurons!=next_layer.features; })==layers.end()
+				, "every layer takes the output of the one before it");
+
+	// the stack is picked by the number of pieces on the board, kings included
+	[[nodiscard]] constexpr static std::size_t layer_stack(const std::size_t number_of_pieces) noexcept
+	{
+		if constexpr(layer_stacks==1)
+			return 0;
+		else
+			return std::min((number_of_pieces-1)*layer_stacks/32, layer_stacks-1);
+	}
+
+	// like "HalfKP 256x2-32-32"
+	[[nodiscard]] static std::string description()
+	{
+		std::string description{std::format("{} {}x2", feature_set::name, transformed_neurons)};
+		for(std::size_t index{1}; index<layers.size(); ++index)
+			description+=std::format("-{}", layers[index].features);
+		if(layer_stacks>1)
+			description+=std::format(" with {} layer stacks", layer_stacks);
+		return description;
+	}
+};
+
+using HalfKP_256x2_32_32=Architecture<HalfKP, 256, 1, Dimensions{512,32}, Dimensions{32,32}, Dimensions{32,1}>;
+
+// the architecture of the default net, the one the engine is built for
+using Default_architecture=HalfKP_256x2_32_32;
+
+#endif // Architecture_h_INCLUDED
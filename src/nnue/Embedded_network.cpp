@@ -0,0 +1,40 @@
+#include "Embedded_network.h"
+
+#ifdef EMBEDDED_NETWORK_PATH
+
+#ifdef __APPLE__
+#define EMBEDDED_NETWORK_SECTION ".const_data"
+#define EMBEDDED_NETWORK_PREVIOUS_SECTION ".text"
+#define EMBEDDED_NETWORK_SYMBOL(name) "_" #name
+#else
+#define EMBEDDED_NETWORK_SECTION ".section .rodata"
+#define EMBEDDED_NETWORK_PREVIOUS_SECTION ".previous"
+#define EMBEDDED_NETWORK_SYMBOL(name) #name
+#endif
+
+// the assembler copies the file into read only memory, aligned for the SIMD loads
+asm(EMBEDDED_NETWORK_SECTION "\n"
+	".balign 64\n"
+	".globl " EMBEDDED_NETWORK_SYMBOL(embedded_network_begin) "\n"
+	EMBEDDED_NETWORK_SYMBOL(embedded_network_begin) ":\n"
+	".incbin \"" EMBEDDED_NETWORK_PATH "\"\n"
+	".globl " EMBEDDED_NETWORK_SYMBOL(embedded_network_end) "\n"
+	EMBEDDED_NETWORK_SYMBOL(embedded_network_end) ":\n"
+	EMBEDDED_NETWORK_PREVIOUS_SECTION "\n");
+
+extern "C" const std::uint8_t embedded_network_begin[];
+extern "C" const std::uint8_t embedded_network_end[];
+
+std::span<const std::uint8_t> embedded_network() noexcept
+{
+	return {embedded_network_begin, embedded_network_end};
+}
+
+#else
+
+std::span<const std::uint8_t> embedded_network() noexcept
+{
+	return {};
+}
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef Embedded_network_h_INCLUDED
+#define Embedded_network_h_INCLUDED
+
+#include <cstdint>
+#include <span>
+
+// the net linked into the binary at build time, empty when the build had none to embed
+[[nodiscard]] std::span<const std::uint8_t> embedded_network() noexcept;
+
+#endif // Embedded_network_h_INCLUDED
@@ -8,7 +8,9 @@ NNUE_header::NNUE_header(std::istream& net_file) noexcept
 		((values=read_little_endian<decltype(values)>(net_file)),...);
 	};
 	read_numerics(version, hash, str_size);
-	assert(version==decltype(version){0x07AF32F16});
+	// the description length of a file that is not a net is meaningless
+	if(version!=expected_version)
+		return;
 
 	description.resize(str_size);
 	net_file.read(description.data(),str_size);
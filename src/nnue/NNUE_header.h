@@ -1,11 +1,14 @@
 #ifndef NNUE_header_h_INCLUDED
 #define NNUE_header_h_INCLUDED
 
-#include <cassert>
+#include <cstdint>
 #include <istream>
+#include <string>
 
 struct NNUE_header
 {
+	constexpr static std::uint32_t expected_version{0x7AF32F16};
+
 	NNUE_header(std::istream& net_file) noexcept;
 
 	std::uint32_t version{0}
@@ -1,38 +1,167 @@
-#include "Accumulator.h"
+#include "Embedded_network.h"
 #include "Neural_network.h"
 
+#include <algorithm>
+#include <format>
 #include <fstream>
+#include <spanstream>
+#include <stdexcept>
 
-Neural_network Neural_network::load_from_file(const std::filesystem::path& path) noexcept
+template <typename architecture_type>
+std::expected<Basic_neural_network<architecture_type>, std::string> Basic_neural_network<architecture_type>::validated(Basic_neural_network neural_network, std::istream& is, const std::string_view name, const std::chrono::steady_clock::time_point start_time) noexcept
 {
-	std::ifstream net_file{path};
-	return Neural_network(net_file);
+	if(neural_network.header.version!=NNUE_header::expected_version)
+		return std::unexpected{std::format("{} has version {:#x}, expected {:#x}", name, neural_network.header.version, NNUE_header::expected_version)};
+	if(!is || is.peek()!=std::istream::traits_type::eof())
+		return std::unexpected{std::format("{} does not have the size of a {} net", name, architecture::description())};
+	// the header hash combines the hashes of the layers, a mismatch means a different architecture
+	for(const auto& layer_stack : neural_network.layer_stacks_)
+	{
+		if(neural_network.header.hash!=(neural_network.feature_transformer.hash^layer_stack.hash))
+			return std::unexpected{std::format("{} has hash {:#x}, its layers give {:#x}", name, neural_network.header.hash, neural_network.feature_transformer.hash^layer_stack.hash)};
+	}
+
+	neural_network.name_=name;
+	neural_network.load_time_=std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start_time);
+	return neural_network;
+}
+
+template <typename architecture_type>
+std::expected<Basic_neural_network<architecture_type>, std::string> Basic_neural_network<architecture_type>::load_from_file(const std::filesystem::path& path) noexcept
+{
+	const auto start_time{std::chrono::steady_clock::now()};
+	std::ifstream net_file{path, std::ios::binary};
+	if(!net_file)
+		return std::unexpected{std::format("could not open {}", path.string())};
+	return validated(Basic_neural_network(net_file), net_file, path.filename().string(), start_time);
+}
+
+template <typename architecture_type>
+std::expected<Basic_neural_network<architecture_type>, std::string> Basic_neural_network<architecture_type>::load_from_memory(std::span<const std::uint8_t> bytes, const std::string_view name) noexcept
+{
+	const auto start_time{std::chrono::steady_clock::now()};
+	std::ispanstream net_stream{std::span{reinterpret_cast<const char*>(bytes.data()), bytes.size()}};
+	return validated(Basic_neural_network(net_stream, bytes), net_stream, name, start_time);
 }
 
-Neural_network::Neural_network(const std::filesystem::path& path)
-	: Neural_network(load_from_file(path))
+template <typename architecture_type>
+std::expected<Basic_neural_network<architecture_type>, std::string> Basic_neural_network<architecture_type>::load_default() noexcept
+{
+	if(embedded_network().empty())
+		return load_from_file(std::filesystem::path{default_file_name});
+	return load_from_memory(embedded_network(), "embedded net");
+}
+
+template <typename architecture_type>
+Basic_neural_network<architecture_type>::Basic_neural_network(const std::filesystem::path& path)
+	: Basic_neural_network([&]
+	{
+		auto neural_network{load_from_file(path)};
+		if(!neural_network)
+			throw std::runtime_error{neural_network.error()};
+		return std::move(*neural_network);
+	}())
 {}
 
-Neural_network::Neural_network(std::istream& is)
+template <typename architecture_type>
+std::string Basic_neural_network<architecture_type>::load_report() const
+{
+	return std::format("loaded {} ({}) in {}", name_, header.description, load_time_);
+}
+
+template <typename architecture_type>
+Basic_neural_network<architecture_type>::Basic_neural_network(std::istream& is, std::span<const std::uint8_t> net_bytes)
 	: header(is)
-	, feature_transformer(is)
-	, dense_layers_hash(read_little_endian<decltype(dense_layers_hash)>(is))
-	, dense_one(is)
-	, dense_two(is)
-	, dense_three(is)
+	, feature_transformer(is, net_bytes)
+{
+	layer_stacks_.reserve(layer_stacks);
+	for(std::size_t index{0}; index<layer_stacks; ++index)
+		layer_stacks_.emplace_back(is);
+}
+
+template <typename architecture_type>
+Basic_neural_network<architecture_type>::Layer_stack::Layer_stack(std::istream& is)
+	: hash(read_little_endian<decltype(hash)>(is))
+	// the layers are read in order, a braced list evaluates its elements left to right
+	, layers([&]<std::size_t... layer_indexes>(std::index_sequence<layer_indexes...>)
+	{
+		return Dense_layers{Dense_linear_layer<architecture::layers[layer_indexes]>(is)...};
+	}(std::make_index_sequence<architecture::layers.size()>{}))
 {}
 
-int Neural_network::evaluate(const engine::Side side_to_move, const Accumulator& accumulator) const noexcept
+template <typename architecture_type>
+int Basic_neural_network<architecture_type>::evaluate(const engine::Side side_to_move, const std::size_t number_of_pieces, const Accumulator& accumulator) const noexcept
 {
-	std::array<std::int16_t, Feature_transformer::dimensions.neurons*2> transformed_features;
-	std::ranges::copy(accumulator[side_to_move]
-					, transformed_features.begin());
-	std::ranges::copy(accumulator[other_side(side_to_move)]
-					, transformed_features.begin()+Feature_transformer::dimensions.neurons);
+	// both perspectives are clipped straight from the accumulator, the side to move first
+	std::array<std::int8_t, architecture::layers.front().features> transformed_features;
+	clipped_ReLU<transformed_neurons>(accumulator[side_to_move], std::span{transformed_features}.template first<transformed_neurons>());
+	clipped_ReLU<transformed_neurons>(accumulator[other_side(side_to_move)], std::span{transformed_features}.template last<transformed_neurons>());
 
-	const auto d1_transformed{dense_one.transform(clipped_ReLU(transformed_features))};
-	const auto d2_transformed{dense_two.transform(clipped_ReLU(d1_transformed,64))};
-	const auto d3_transformed{dense_three.transform(clipped_ReLU(d2_transformed,64))};
+	return propagate<0>(layer_stacks_[architecture::layer_stack(number_of_pieces)].layers, transformed_features);
+}
 
-	return d3_transformed.front();
+template <typename architecture_type>
+template <std::size_t layer_index>
+int Basic_neural_network<architecture_type>::propagate(const Dense_layers& layers, const std::array<std::int8_t, architecture::layers[layer_index].features>& input) noexcept
+{
+	const auto output{std::get<layer_index>(layers).transform(input)};
+	if constexpr(layer_index+1==architecture::layers.size())
+		return output.front();
+	else
+		return propagate<layer_index+1>(layers, clipped_ReLU(output,64));
 }
+
+template <typename architecture_type>
+void Basic_neural_network<architecture_type>::evaluate(std::span<const Batch_entry> batch, std::span<int> evaluations) const noexcept
+{
+	constexpr std::size_t input_size{architecture::layers.front().features};
+	std::array<std::int8_t, max_batch_size*input_size> inputs;
+	std::array<std::size_t, max_batch_size> batch_indexes;
+	std::array<int, max_batch_size> stack_evaluations;
+	for(std::size_t stack_index{0}; stack_index<layer_stacks; ++stack_index)
+	{
+		std::size_t size{0};
+		const auto propagate_inputs=[&]
+		{
+			propagate_batch<0>(layer_stacks_[stack_index].layers, std::span{inputs}.first(size*input_size), std::span{stack_evaluations}.first(size));
+			for(std::size_t index{0}; index<size; ++index)
+				evaluations[batch_indexes[index]]=stack_evaluations[index];
+			size=0;
+		};
+
+		for(std::size_t batch_index{0}; batch_index<batch.size(); ++batch_index)
+		{
+			const Batch_entry& entry{batch[batch_index]};
+			if(architecture::layer_stack(entry.number_of_pieces)!=stack_index)
+				continue;
+			const std::span<std::int8_t, input_size> input{inputs.data()+size*input_size, input_size};
+			clipped_ReLU<transformed_neurons>((*entry.accumulator)[entry.side_to_move], input.template first<transformed_neurons>());
+			clipped_ReLU<transformed_neurons>((*entry.accumulator)[other_side(entry.side_to_move)], input.template last<transformed_neurons>());
+			batch_indexes[size++]=batch_index;
+			if(size==max_batch_size)
+				propagate_inputs();
+		}
+		if(size>0)
+			propagate_inputs();
+	}
+}
+
+template <typename architecture_type>
+template <std::size_t layer_index>
+void Basic_neural_network<architecture_type>::propagate_batch(const Dense_layers& layers, std::span<const std::int8_t> inputs, std::span<int> evaluations) noexcept
+{
+	constexpr Dimensions dimensions{architecture::layers[layer_index]};
+	const std::size_t size{evaluations.size()};
+	std::array<std::int32_t, max_batch_size*dimensions.neurons> outputs;
+	std::get<layer_index>(layers).transform(inputs, std::span{outputs}.first(size*dimensions.neurons));
+	if constexpr(layer_index+1==architecture::layers.size())
+		std::ranges::copy(std::span{outputs}.first(size), evaluations.begin());
+	else
+	{
+		std::array<std::int8_t, max_batch_size*dimensions.neurons> activations;
+		simd_kernels::kernels().clipped_ReLU_32(outputs.data(), size*dimensions.neurons, 64, activations.data());
+		propagate_batch<layer_index+1>(layers, std::span{activations}.first(size*dimensions.neurons), evaluations);
+	}
+}
+
+template class Basic_neural_network<Default_architecture>;
@@ -1,34 +1,78 @@
 #ifndef Neural_network_h_INCLUDED
 #define Neural_network_h_INCLUDED
 
+#include <chrono>
+#include <expected>
 #include <filesystem>
 #include <istream>
 #include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
 
+#include "Architecture.h"
 #include "common.h"
 #include "../Constants.h"
-#include "../Constants.h"
 #include "layers/Dense_linear_layer.h"
 #include "layers/Feature_transformer.h"
 #include "NNUE_header.h"
+#include "simd_kernels.h"
 #include "../Pieces.h"
 #include "../Position.h"
 
-class Neural_network
+// the feature indexes, the accumulator size and the forward pass all follow from the architecture
+template <typename architecture_type>
+class Basic_neural_network
 {
 	public:
 
-	Neural_network(std::istream& is);
-	Neural_network(const std::filesystem::path& path);
-	[[nodiscard]] static Neural_network load_from_file(const std::filesystem::path& path) noexcept;
-	[[nodiscard]] int evaluate(const engine::Side side_to_move, const engine::Side_map<std::array<std::int16_t, Feature_transformer::dimensions.neurons>>& accumulator) const noexcept;
-	void transform_features(std::span<const std::uint16_t> features, std::span<Feature_transformer::bias_type, Feature_transformer::dimensions.neurons> accumulator) const noexcept
+	using architecture=architecture_type;
+	using Feature_transformer=::Feature_transformer<architecture::transformer_dimensions>;
+
+	constexpr static std::size_t transformed_neurons{architecture::transformer_dimensions.neurons};
+	constexpr static std::size_t layer_stacks{architecture::layer_stacks};
+	// nets whose kings are features also change the other perspective when a king moves
+	constexpr static bool king_is_feature{architecture::feature_set::king_is_feature};
+	constexpr static std::string_view default_file_name{"nn-97f742aaefcd.nnue"};
+	// batches are evaluated in groups of this many positions per layer stack
+	constexpr static std::size_t max_batch_size{32};
+
+	using Accumulator=engine::Side_map<std::array<std::int16_t, transformed_neurons>>;
+
+	// a position of a batch, the accumulator is only borrowed
+	struct Batch_entry
+	{
+		engine::Side side_to_move;
+		std::size_t number_of_pieces;
+		const Accumulator* accumulator;
+	};
+
+	Basic_neural_network(std::istream& is, std::span<const std::uint8_t> net_bytes={});
+	// throws if the file is not a valid net
+	Basic_neural_network(const std::filesystem::path& path);
+	// the error says why the net was rejected
+	[[nodiscard]] static std::expected<Basic_neural_network, std::string> load_from_file(const std::filesystem::path& path) noexcept;
+	// the weights are used in place, the bytes must outlive the net
+	[[nodiscard]] static std::expected<Basic_neural_network, std::string> load_from_memory(std::span<const std::uint8_t> bytes, const std::string_view name) noexcept;
+	// the net embedded at build time, or default_file_name in the working directory if none was
+	[[nodiscard]] static std::expected<Basic_neural_network, std::string> load_default() noexcept;
+	// the net's description and how long it took to load, for an info string
+	[[nodiscard]] std::string load_report() const;
+	// the number of pieces picks the layer stack
+	[[nodiscard]] int evaluate(const engine::Side side_to_move, const std::size_t number_of_pieces, const Accumulator& accumulator) const noexcept;
+	// the dense layers take the positions of a batch together so every weight loaded serves several of them,
+	// evaluations[i] is the evaluation of batch[i]
+	void evaluate(std::span<const Batch_entry> batch, std::span<int> evaluations) const noexcept;
+	void transform_features(std::span<const std::uint16_t> features, std::span<typename Feature_transformer::bias_type, transformed_neurons> accumulator) const noexcept
 	{
 		feature_transformer.transform(features,accumulator);
 	}
-	void adjust_accumulator(std::span<const std::uint16_t> feature_indices, const auto& reduction, std::span<Feature_transformer::bias_type, Feature_transformer::dimensions.neurons> adjusted) const noexcept
+	void adjust_accumulator(std::span<const typename Feature_transformer::bias_type, transformed_neurons> input, std::span<const std::uint16_t> removed_features, std::span<const std::uint16_t> added_features, std::span<typename Feature_transformer::bias_type, transformed_neurons> adjusted) const noexcept
 	{
-		feature_transformer.adjust(feature_indices,reduction,adjusted);
+		feature_transformer.adjust(input,removed_features,added_features,adjusted);
 	}
 	[[nodiscard]] static std::uint16_t compute_feature_index(const engine::Piece piece
 											 , const engine::Position& position
@@ -36,41 +80,54 @@ class Neural_network
 											 , const engine::Side current_side
 											 , const engine::Side perspective) noexcept
 	{
-		const auto feature_index=[&](const auto& index_strategy, const engine::Side current_side)
-		{
-			const auto piece_index_no_king{std::to_underlying(piece)-1};
-			const auto piece_feature_index{2*piece_index_no_king + std::to_underlying(current_side)};
-			return 1 + index_strategy(position) + index_strategy(king_square) + (piece_feature_index+10*index_strategy(king_square))*64;
-		};
-
-		if(perspective==engine::Side::white)
-			return feature_index(engine::to_index, current_side);
-		if(perspective==engine::Side::black)
-			return feature_index([](const engine::Position& position){ return 63-to_index(position); }, other_side(current_side));
-		std::unreachable();
+		return architecture::feature_set::feature_index(piece, position, king_square, current_side, perspective);
 	};
 
 	private:
 
-	template <numeric numeric_type, std::size_t size>
-	std::array<std::int8_t, size> clipped_ReLU(const std::array<numeric_type, size>& input, const int multiple_of_one_value=1) const noexcept
+	// clamps to [0, 127] and narrows to int8 in one pass
+	template <std::size_t size>
+	static void clipped_ReLU(std::span<const std::int16_t, size> input, std::span<std::int8_t, size> output) noexcept
+	{
+		simd_kernels::kernels().clipped_ReLU_16(input.data(), size, output.data());
+	}
+
+	template <std::size_t size>
+	static std::array<std::int8_t, size> clipped_ReLU(const std::array<std::int32_t, size>& input, const int multiple_of_one_value) noexcept
 	{
 		std::array<std::int8_t, size> output;
-		for(auto&& [new_value, value] : std::views::zip(output, input))
-			new_value=std::clamp(value/multiple_of_one_value,0,127);
+		simd_kernels::kernels().clipped_ReLU_32(input.data(), size, multiple_of_one_value, output.data());
 		return output;
 	}
 
-	constexpr static Dimensions dense_one_dimensions{512,32},
-								dense_two_dimensions{32,32},
-								dense_three_dimensions{32,1};
+	template <std::size_t... layer_indexes>
+	static auto dense_layers_of(std::index_sequence<layer_indexes...>) -> std::tuple<Dense_linear_layer<architecture::layers[layer_indexes]>...>;
+	using Dense_layers=decltype(dense_layers_of(std::make_index_sequence<architecture::layers.size()>{}));
+
+	// the dense layers that follow the feature transformer, the net holds one per layer stack
+	struct Layer_stack
+	{
+		explicit Layer_stack(std::istream& is);
+
+		std::uint32_t hash;
+		Dense_layers layers;
+	};
+
+	template <std::size_t layer_index>
+	[[nodiscard]] static int propagate(const Dense_layers& layers, const std::array<std::int8_t, architecture::layers[layer_index].features>& input) noexcept;
+	// inputs holds the inputs of the batch one after the other
+	template <std::size_t layer_index>
+	static void propagate_batch(const Dense_layers& layers, std::span<const std::int8_t> inputs, std::span<int> evaluations) noexcept;
+
+	[[nodiscard]] static std::expected<Basic_neural_network, std::string> validated(Basic_neural_network neural_network, std::istream& is, const std::string_view name, const std::chrono::steady_clock::time_point start_time) noexcept;
 
 	NNUE_header header;
+	std::string name_;
+	std::chrono::milliseconds load_time_{0};
 	Feature_transformer feature_transformer;
-	std::uint32_t dense_layers_hash;
-	Dense_linear_layer<dense_one_dimensions> dense_one;
-	Dense_linear_layer<dense_two_dimensions> dense_two;
-	Dense_linear_layer<dense_three_dimensions> dense_three;
+	std::vector<Layer_stack> layer_stacks_;
 };
 
+using Neural_network=Basic_neural_network<Default_architecture>;
+
 #endif
@@ -1,8 +1,10 @@
 #ifndef common_h_INCLUDED
 #define common_h_INCLUDED
 
+#include <bit>
 #include <concepts>
 #include <istream>
+#include <span>
 
 struct Dimensions { std::size_t features{0}, neurons{0}; };
 
@@ -14,9 +16,23 @@ numeric_type read_little_endian(std::istream& is)
 {
 	numeric_type result;
 	is.read(reinterpret_cast<char*>(&result),sizeof(numeric_type));
+	if constexpr(std::endian::native==std::endian::big)
+		result=std::byteswap(result);
 	return result;
 }
 
+// fills values with a single read, only big endian hosts touch the values again
+template <std::integral numeric_type>
+void read_little_endian(std::istream& is, std::span<numeric_type> values)
+{
+	is.read(reinterpret_cast<char*>(values.data()), values.size_bytes());
+	if constexpr(std::endian::native==std::endian::big)
+	{
+		for(auto& value : values)
+			value=std::byteswap(value);
+	}
+}
+
 template <typename numeric_type>
 	requires std::is_reference_v<numeric_type> && numeric<std::decay_t<numeric_type>>
 auto read_little_endian(std::istream& is)
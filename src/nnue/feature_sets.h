@@ -0,0 +1,66 @@
+#ifndef feature_sets_h_INCLUDED
+#define feature_sets_h_INCLUDED
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+#include "../Constants.h"
+#include "../Pieces.h"
+#include "../Position.h"
+
+// every piece but the kings relative to the king of the perspective
+struct HalfKP
+{
+	constexpr static std::string_view name{"HalfKP"};
+	constexpr static std::size_t dimensions{41024};
+	constexpr static bool king_is_feature{false};
+
+	[[nodiscard]] static std::uint16_t feature_index(const engine::Piece piece
+															  , const engine::Position& position
+															  , const engine::Position& king_square
+															  , const engine::Side piece_side
+															  , const engine::Side perspective) noexcept
+	{
+		const auto feature_index=[&](const auto& index_strategy, const engine::Side piece_side)
+		{
+			const auto piece_index_no_king{std::to_underlying(piece)-1};
+			const auto piece_feature_index{2*piece_index_no_king + std::to_underlying(piece_side)};
+			return 1 + index_strategy(position) + index_strategy(king_square) + (piece_feature_index+10*index_strategy(king_square))*64;
+		};
+
+		if(perspective==engine::Side::white)
+			return feature_index(engine::to_index, piece_side);
+		if(perspective==engine::Side::black)
+			return feature_index([](const engine::Position& position){ return 63-to_index(position); }, other_side(piece_side));
+		std::unreachable();
+	}
+};
+
+// every piece including both kings relative to the king of the perspective, the board is mirrored so that king
+// stands on the e to h files, which leaves 32 king buckets
+struct HalfKAv2_hm
+{
+	constexpr static std::string_view name{"HalfKAv2_hm"};
+	constexpr static std::size_t king_buckets{32}, piece_squares{11*engine::board_size*engine::board_size};
+	constexpr static std::size_t dimensions{king_buckets*piece_squares};
+	constexpr static bool king_is_feature{true};
+
+	[[nodiscard]] static std::uint16_t feature_index(const engine::Piece piece
+															  , const engine::Position& position
+															  , const engine::Position& king_square
+															  , const engine::Side piece_side
+															  , const engine::Side perspective) noexcept
+	{
+		constexpr std::size_t squares{engine::board_size*engine::board_size};
+		// flips the ranks for black and the files when the king is on the queenside
+		const std::size_t orientation{(perspective==engine::Side::white? 0u : 56u) ^ (king_square.file_<4? 7u : 0u)};
+		const std::size_t oriented_king_square{to_index(king_square)^orientation};
+		const std::size_t king_bucket{(7-oriented_king_square/8)*4 + (7-oriented_king_square%8)};
+		// both kings share one plane
+		const std::size_t piece_index{piece==engine::Piece::king? 10u : 2u*(std::to_underlying(piece)-1u) + (piece_side!=perspective)};
+		return (to_index(position)^orientation) + piece_index*squares + king_bucket*piece_squares;
+	}
+};
+
+#endif // feature_sets_h_INCLUDED
@@ -1,8 +1,9 @@
 #ifndef Dense_linear_layer_h_INCLUDED
 #define Dense_linear_layer_h_INCLUDED
 
-#include <experimental/simd>
+#include <array>
 #include <istream>
+#include <span>
 #include <vector>
 
 #include "../common.h"
@@ -18,17 +19,21 @@ class Dense_linear_layer
 
 	Dense_linear_layer(std::istream& net_file) noexcept;
 
+	// only the non-zero inputs are applied, after a clipped ReLU most of them are zero
 	[[nodiscard]] std::array<bias_type, layer_dimensions.neurons> transform(const std::array<std::int8_t, layer_dimensions.features>& column_vector) const noexcept;
+	// inputs holds whole input vectors one after the other, outputs receives the results in the same order
+	void transform(std::span<const std::int8_t> inputs, std::span<bias_type> outputs) const noexcept;
 
 	private:
 
 	std::vector<bias_type> biases;
 	std::vector<weight_type> weights_data;
 
+	// the net stores the weights row by row, they are kept column major so the weights of one input are contiguous
 	template <typename contained_type>
 	using helper_weights_container=std::experimental::mdspan<contained_type
 												   , std::experimental::extents<std::size_t,layer_dimensions.neurons, layer_dimensions.features>
-												   , std::experimental::layout_right>;
+												   , std::experimental::layout_left>;
 
 	using weights_container=helper_weights_container<weight_type>;
 	using const_weights_container=helper_weights_container<const weight_type>;
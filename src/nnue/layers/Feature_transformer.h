@@ -2,52 +2,46 @@
 #define Feature_transformer_h_INCLUDED
 
 #include <cstdint>
-#include <experimental/bits/simd.h>
 #include <istream>
+#include <span>
 #include <vector>
 
 #include "../common.h"
-#include "mdspan.h"
 
+template <Dimensions transformer_dimensions>
 class Feature_transformer
 {
 	public:
 
+	constexpr static Dimensions dimensions{transformer_dimensions};
+
 	using bias_type=std::int16_t;
 	using weight_type=std::int16_t;
 
+	// with the bytes of the whole net the weights are used where they lie instead of being copied,
+	// the bytes must then outlive the transformer
+	Feature_transformer(std::istream& net_file, std::span<const std::uint8_t> net_bytes={}) noexcept;
 
-	Feature_transformer(std::istream& net_file) noexcept;
-
-	constexpr static Dimensions dimensions{41024,256};
 	void transform(std::span<const std::uint16_t> active_feature_indexes
 				 , std::span<bias_type, dimensions.neurons> transformed) const noexcept;
-	void adjust(std::span<const std::uint16_t> feature_indexes
-			  , const auto& reduction
-			  , std::span<bias_type, dimensions.neurons> adjusted) const noexcept
-	{
-		// Even with column major, it is faster to loop over the features first
-		const_weights_container weights{weights_data.data()};
-		for(const auto& feature : feature_indexes)
-		{
-			for(std::size_t i{0}; i<dimensions.neurons; ++i)
-				adjusted[i]=reduction(adjusted[i], weights[i,feature]);
-		}
-	}
+	// subtracts the removed feature columns from input and adds the added ones in a single pass over the neurons,
+	// input and adjusted may be the same
+	void adjust(std::span<const bias_type, dimensions.neurons> input
+			  , std::span<const std::uint16_t> removed_feature_indexes
+			  , std::span<const std::uint16_t> added_feature_indexes
+			  , std::span<bias_type, dimensions.neurons> adjusted) const noexcept;
 
 	std::uint32_t hash;
 	std::vector<bias_type> biases;
-	std::vector<weight_type> weights_data;
 
 	private:
 
-	template <typename contained_type>
-	using helper_weights_container=std::experimental::mdspan<contained_type
-												   , std::experimental::extents<std::size_t, dimensions.neurons, dimensions.features>
-												   , std::experimental::layout_left>;
+	[[nodiscard]] inline const weight_type* weights_data() const noexcept { return borrowed_weights_data_? borrowed_weights_data_ : weights_data_.data(); }
 
-	using weights_container=helper_weights_container<weight_type>;
-	using const_weights_container=helper_weights_container<const weight_type>;
+	std::vector<weight_type> weights_data_;
+	const weight_type* borrowed_weights_data_{nullptr};
 };
 
+#include "Feature_transformer_impl.h"
+
 #endif // Feature_transformer_h_INCLUDED
@@ -0,0 +1,51 @@
+#include "../simd_kernels.h"
+
+#include <bit>
+#include <cstdint>
+#include <span>
+
+template <Dimensions transformer_dimensions>
+Feature_transformer<transformer_dimensions>::Feature_transformer(std::istream& net_file, std::span<const std::uint8_t> net_bytes) noexcept
+	: biases(dimensions.neurons)
+{
+	constexpr std::size_t weights_size{dimensions.neurons*dimensions.features*sizeof(weight_type)};
+	hash=read_little_endian<decltype(hash)>(net_file);
+	read_little_endian(net_file, std::span{biases});
+
+	// the net stores the weights feature by feature, which is already the column major layout
+	const std::size_t offset{static_cast<std::size_t>(static_cast<std::streamoff>(net_file.tellg()))};
+	const bool can_borrow{std::endian::native==std::endian::little
+						  && net_file
+						  && offset+weights_size<=net_bytes.size()
+						  && reinterpret_cast<std::uintptr_t>(net_bytes.data()+offset)%alignof(weight_type)==0};
+	if(can_borrow)
+	{
+		borrowed_weights_data_=reinterpret_cast<const weight_type*>(net_bytes.data()+offset);
+		net_file.seekg(weights_size, std::ios::cur);
+	}
+	else
+	{
+		weights_data_.resize(dimensions.neurons*dimensions.features);
+		read_little_endian(net_file, std::span{weights_data_});
+	}
+}
+
+template <Dimensions transformer_dimensions>
+void Feature_transformer<transformer_dimensions>::transform(std::span<const std::uint16_t> active_feature_indexes
+								  , std::span<bias_type, dimensions.neurons> transformed) const noexcept
+{
+	// feature major, every active feature adds its contiguous column to the biases
+	adjust(std::span<const bias_type, dimensions.neurons>{biases.data(), dimensions.neurons}, {}, active_feature_indexes, transformed);
+}
+
+template <Dimensions transformer_dimensions>
+void Feature_transformer<transformer_dimensions>::adjust(std::span<const bias_type, dimensions.neurons> input
+							   , std::span<const std::uint16_t> removed_feature_indexes
+							   , std::span<const std::uint16_t> added_feature_indexes
+							   , std::span<bias_type, dimensions.neurons> adjusted) const noexcept
+{
+	simd_kernels::kernels().adjust(input.data()
+								 , removed_feature_indexes.data(), removed_feature_indexes.size()
+								 , added_feature_indexes.data(), added_feature_indexes.size()
+								 , weights_data(), dimensions.neurons, adjusted.data());
+}
@@ -0,0 +1,26 @@
+#include "simd_kernels.h"
+
+namespace simd_kernels
+{
+	namespace generic { extern const Kernels kernels; }
+#ifdef SIMD_KERNELS_X86
+	namespace avx2 { extern const Kernels kernels; }
+	namespace avx512 { extern const Kernels kernels; }
+#endif
+
+	const Kernels& kernels() noexcept
+	{
+		static const Kernels& selected{[]() -> const Kernels&
+		{
+#ifdef SIMD_KERNELS_X86
+			// each copy is built with exactly the extensions checked for it, -mavx512f -mavx512bw and -mavx2
+			if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+				return avx512::kernels;
+			if(__builtin_cpu_supports("avx2"))
+				return avx2::kernels;
+#endif
+			return generic::kernels;
+		}()};
+		return selected;
+	}
+}
@@ -0,0 +1,37 @@
+#ifndef simd_kernels_h_INCLUDED
+#define simd_kernels_h_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// the vectorised NNUE loops are compiled once per instruction set level,
+// the best level the processor supports is chosen the first time they are used
+namespace simd_kernels
+{
+	// the most inputs a dense layer may have
+	constexpr std::size_t max_dense_features{2048};
+
+	struct Kernels
+	{
+		std::string_view level;
+		// output=input-removed columns+added columns, the weights are column major with neurons weights per column
+		void (*adjust)(const std::int16_t* input
+					 , const std::uint16_t* removed_features, std::size_t number_of_removed
+					 , const std::uint16_t* added_features, std::size_t number_of_added
+					 , const std::int16_t* weights, std::size_t neurons, std::int16_t* output) noexcept;
+		// clamps to [0, 127] after dividing by divisor and narrows to int8
+		void (*clipped_ReLU_16)(const std::int16_t* input, std::size_t size, std::int8_t* output) noexcept;
+		void (*clipped_ReLU_32)(const std::int32_t* input, std::size_t size, int divisor, std::int8_t* output) noexcept;
+		// output=biases+weights*input with column major weights, only the non-zero inputs are applied
+		void (*dense)(const std::int8_t* input, std::size_t features
+					, const std::int8_t* weights, const std::int32_t* biases, std::size_t neurons, std::int32_t* output) noexcept;
+		// dense for batch_size inputs stored one after the other, the outputs are stored the same way
+		void (*dense_batch)(const std::int8_t* inputs, std::size_t batch_size, std::size_t features
+						  , const std::int8_t* weights, const std::int32_t* biases, std::size_t neurons, std::int32_t* outputs) noexcept;
+	};
+
+	[[nodiscard]] const Kernels& kernels() noexcept;
+}
+
+#endif // simd_kernels_h_INCLUDED
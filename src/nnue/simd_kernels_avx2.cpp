@@ -0,0 +1,3 @@
+#define SIMD_KERNELS_LEVEL avx2
+#define SIMD_KERNELS_LEVEL_NAME "avx2"
+#include "simd_kernels_impl.h"
@@ -0,0 +1,3 @@
+#define SIMD_KERNELS_LEVEL avx512
+#define SIMD_KERNELS_LEVEL_NAME "avx512"
+#include "simd_kernels_impl.h"
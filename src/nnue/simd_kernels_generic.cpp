@@ -0,0 +1,3 @@
+#define SIMD_KERNELS_LEVEL generic
+#define SIMD_KERNELS_LEVEL_NAME "generic"
+#include "simd_kernels_impl.h"
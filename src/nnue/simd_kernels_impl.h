@@ -0,0 +1,212 @@
+// included once per instruction set level with SIMD_KERNELS_LEVEL naming it, every translation unit is compiled
+// with that level's flags, so nothing here may have external linkage or the linker could mix the levels up
+
+#include "simd_kernels.h"
+
+#include <algorithm>
+#include <experimental/simd>
+
+namespace simd_kernels::SIMD_KERNELS_LEVEL
+{
+	namespace
+	{
+		namespace stdx=std::experimental;
+
+		void adjust(const std::int16_t* input
+				  , const std::uint16_t* removed_features, const std::size_t number_of_removed
+				  , const std::uint16_t* added_features, const std::size_t number_of_added
+				  , const std::int16_t* weights, const std::size_t neurons, std::int16_t* output) noexcept
+		{
+			using simd_type=stdx::native_simd<std::int16_t>;
+			// a tile of neurons stays in registers while every feature column is applied, so the accumulator is loaded and stored once
+			constexpr std::size_t registers_per_tile{8}, tile_size{registers_per_tile*simd_type::size()};
+			std::size_t tile_start{0};
+			for(; tile_start+tile_size<=neurons; tile_start+=tile_size)
+			{
+				simd_type tile[registers_per_tile];
+				for(std::size_t i{0}; i<registers_per_tile; ++i)
+					tile[i].copy_from(input+tile_start+i*simd_type::size(), stdx::element_aligned);
+
+				for(std::size_t feature{0}; feature<number_of_removed; ++feature)
+				{
+					const std::int16_t* column{weights+removed_features[feature]*neurons+tile_start};
+					for(std::size_t i{0}; i<registers_per_tile; ++i)
+						tile[i]-=simd_type{column+i*simd_type::size(), stdx::element_aligned};
+				}
+				for(std::size_t feature{0}; feature<number_of_added; ++feature)
+				{
+					const std::int16_t* column{weights+added_features[feature]*neurons+tile_start};
+					for(std::size_t i{0}; i<registers_per_tile; ++i)
+						tile[i]+=simd_type{column+i*simd_type::size(), stdx::element_aligned};
+				}
+
+				for(std::size_t i{0}; i<registers_per_tile; ++i)
+					tile[i].copy_to(output+tile_start+i*simd_type::size(), stdx::element_aligned);
+			}
+			// transformers narrower than a tile finish a register and then a neuron at a time
+			for(; tile_start+simd_type::size()<=neurons; tile_start+=simd_type::size())
+			{
+				simd_type part{input+tile_start, stdx::element_aligned};
+				for(std::size_t feature{0}; feature<number_of_removed; ++feature)
+					part-=simd_type{weights+removed_features[feature]*neurons+tile_start, stdx::element_aligned};
+				for(std::size_t feature{0}; feature<number_of_added; ++feature)
+					part+=simd_type{weights+added_features[feature]*neurons+tile_start, stdx::element_aligned};
+				part.copy_to(output+tile_start, stdx::element_aligned);
+			}
+			for(; tile_start<neurons; ++tile_start)
+			{
+				std::int16_t value{input[tile_start]};
+				for(std::size_t feature{0}; feature<number_of_removed; ++feature)
+					value-=weights[removed_features[feature]*neurons+tile_start];
+				for(std::size_t feature{0}; feature<number_of_added; ++feature)
+					value+=weights[added_features[feature]*neurons+tile_start];
+				output[tile_start]=value;
+			}
+		}
+
+		void clipped_ReLU_16(const std::int16_t* input, const std::size_t size, std::int8_t* output) noexcept
+		{
+			using simd_type=stdx::native_simd<std::int16_t>;
+			std::size_t i{0};
+			for(; i+simd_type::size()<=size; i+=simd_type::size())
+				stdx::clamp(simd_type{input+i, stdx::element_aligned}, simd_type{0}, simd_type{127}).copy_to(output+i, stdx::element_aligned);
+			for(; i<size; ++i)
+				output[i]=std::clamp<std::int16_t>(input[i], 0, 127);
+		}
+
+		void clipped_ReLU_32(const std::int32_t* input, const std::size_t size, const int divisor, std::int8_t* output) noexcept
+		{
+			using simd_type=stdx::native_simd<std::int32_t>;
+			std::size_t i{0};
+			for(; i+simd_type::size()<=size; i+=simd_type::size())
+				stdx::clamp(simd_type{input+i, stdx::element_aligned}/divisor, simd_type{0}, simd_type{127}).copy_to(output+i, stdx::element_aligned);
+			for(; i<size; ++i)
+				output[i]=std::clamp(input[i]/divisor, 0, 127);
+		}
+
+		void dense(const std::int8_t* input, const std::size_t features
+				 , const std::int8_t* weights, const std::int32_t* biases, const std::size_t neurons, std::int32_t* output) noexcept
+		{
+			using simd_type=stdx::native_simd<std::int32_t>;
+			// collected without branching, the zeros are rarely predictable
+			std::uint16_t non_zero_features[max_dense_features];
+			std::size_t number_of_non_zero{0};
+			for(std::size_t feature{0}; feature<features; ++feature)
+			{
+				non_zero_features[number_of_non_zero]=feature;
+				number_of_non_zero+=input[feature]!=0;
+			}
+
+			std::size_t neuron{0};
+			for(; neuron+simd_type::size()<=neurons; neuron+=simd_type::size())
+			{
+				simd_type result{biases+neuron, stdx::element_aligned};
+				for(std::size_t i{0}; i<number_of_non_zero; ++i)
+				{
+					const std::size_t feature{non_zero_features[i]};
+					result+=simd_type{weights+feature*neurons+neuron, stdx::element_aligned}*input[feature];
+				}
+				result.copy_to(output+neuron, stdx::element_aligned);
+			}
+			for(; neuron<neurons; ++neuron)
+			{
+				std::int32_t result{biases[neuron]};
+				for(std::size_t i{0}; i<number_of_non_zero; ++i)
+					result+=weights[non_zero_features[i]*neurons+neuron]*input[non_zero_features[i]];
+				output[neuron]=result;
+			}
+		}
+
+		void dense_batch(const std::int8_t* inputs, const std::size_t batch_size, const std::size_t features
+					   , const std::int8_t* weights, const std::int32_t* biases, const std::size_t neurons, std::int32_t* outputs) noexcept
+		{
+			using simd_type=stdx::native_simd<std::int32_t>;
+			// each weight register loaded is applied to a block of inputs, a feature is skipped when it is zero in all of them
+			constexpr std::size_t block_size{4};
+
+			std::size_t first_input{0};
+			for(; first_input+block_size<=batch_size; first_input+=block_size)
+			{
+				const std::int8_t* block{inputs+first_input*features};
+				std::uint16_t non_zero_features[max_dense_features];
+				std::size_t number_of_non_zero{0};
+				for(std::size_t feature{0}; feature<features; ++feature)
+				{
+					non_zero_features[number_of_non_zero]=feature;
+					number_of_non_zero+=(block[feature] | block[features+feature] | block[2*features+feature] | block[3*features+feature])!=0;
+				}
+
+				std::size_t neuron{0};
+				// two registers of neurons share the broadcast inputs
+				for(; neuron+2*simd_type::size()<=neurons; neuron+=2*simd_type::size())
+				{
+					simd_type low_0{biases+neuron, stdx::element_aligned}, low_1{low_0}, low_2{low_0}, low_3{low_0};
+					simd_type high_0{biases+neuron+simd_type::size(), stdx::element_aligned}, high_1{high_0}, high_2{high_0}, high_3{high_0};
+					for(std::size_t non_zero_index{0}; non_zero_index<number_of_non_zero; ++non_zero_index)
+					{
+						const std::size_t feature{non_zero_features[non_zero_index]};
+						const simd_type low_column{weights+feature*neurons+neuron, stdx::element_aligned};
+						const simd_type high_column{weights+feature*neurons+neuron+simd_type::size(), stdx::element_aligned};
+						const simd_type input_0{block[feature]}, input_1{block[features+feature]}, input_2{block[2*features+feature]}, input_3{block[3*features+feature]};
+						low_0+=low_column*input_0;
+						low_1+=low_column*input_1;
+						low_2+=low_column*input_2;
+						low_3+=low_column*input_3;
+						high_0+=high_column*input_0;
+						high_1+=high_column*input_1;
+						high_2+=high_column*input_2;
+						high_3+=high_column*input_3;
+					}
+					std::int32_t* block_outputs{outputs+first_input*neurons+neuron};
+					for(std::size_t i{0}; const auto& [low, high] : {std::pair{low_0, high_0}, {low_1, high_1}, {low_2, high_2}, {low_3, high_3}})
+					{
+						low.copy_to(block_outputs+i*neurons, stdx::element_aligned);
+						high.copy_to(block_outputs+i*neurons+simd_type::size(), stdx::element_aligned);
+						++i;
+					}
+				}
+				for(; neuron+simd_type::size()<=neurons; neuron+=simd_type::size())
+				{
+					// named rather than an array so they stay in registers
+					simd_type result_0{biases+neuron, stdx::element_aligned}, result_1{result_0}, result_2{result_0}, result_3{result_0};
+					for(std::size_t non_zero_index{0}; non_zero_index<number_of_non_zero; ++non_zero_index)
+					{
+						const std::size_t feature{non_zero_features[non_zero_index]};
+						const simd_type column{weights+feature*neurons+neuron, stdx::element_aligned};
+						result_0+=column*block[feature];
+						result_1+=column*block[features+feature];
+						result_2+=column*block[2*features+feature];
+						result_3+=column*block[3*features+feature];
+					}
+					std::int32_t* block_outputs{outputs+first_input*neurons+neuron};
+					result_0.copy_to(block_outputs, stdx::element_aligned);
+					result_1.copy_to(block_outputs+neurons, stdx::element_aligned);
+					result_2.copy_to(block_outputs+2*neurons, stdx::element_aligned);
+					result_3.copy_to(block_outputs+3*neurons, stdx::element_aligned);
+				}
+				for(; neuron<neurons; ++neuron)
+				{
+					for(std::size_t i{0}; i<block_size; ++i)
+					{
+						std::int32_t result{biases[neuron]};
+						for(std::size_t non_zero_index{0}; non_zero_index<number_of_non_zero; ++non_zero_index)
+							result+=weights[non_zero_features[non_zero_index]*neurons+neuron]*block[i*features+non_zero_features[non_zero_index]];
+						outputs[(first_input+i)*neurons+neuron]=result;
+					}
+				}
+			}
+			for(; first_input<batch_size; ++first_input)
+				dense(inputs+first_input*features, features, weights, biases, neurons, outputs+first_input*neurons);
+		}
+	}
+
+	extern constinit const Kernels kernels;
+	constinit const Kernels kernels{
+		.level=SIMD_KERNELS_LEVEL_NAME,
+		.adjust=adjust,
+		.clipped_ReLU_16=clipped_ReLU_16,
+		.clipped_ReLU_32=clipped_ReLU_32,
+		.dense=dense,
+		.dense_batch=dense_batch,
+	};
+}
@@ -12,6 +12,9 @@
 #include <array>
 #include <format>
 #include <limits>
+#include <numeric>
+#include <thread>
+#include <tuple>
 
 namespace engine
 {
@@ -38,49 +41,205 @@ namespace engine
 		struct Search_context
 		{
 			State& state;
-			Accumulator& accumulator;
-			unsigned& nodes, &extended_depth;
+			Accumulator_stack& accumulators;
+			Node_counter& nodes;
+			Node_counter& tbhits;
+			Correction_history& correction_history;
+			unsigned& selective_depth;
+			Transposition_table& transposition_table;
 
 			const std::atomic<bool>& should_stop_searching;
+			std::span<const Node_counter> node_counters;
+			std::span<const Node_counter> tbhit_counters;
 			const Search_options& search_options;
 			const Time_manager& time_manager;
 			const Neural_network& neural_network;
+			const syzygy::Tablebases& tablebases;
 		};
 
+		enum class node_limit_reached {};
+
+		// being mated at ply n scores -mate_score+n, so shorter mates score higher
+		constexpr int mate_score{std::numeric_limits<int>::max()-10000};
+		// check evasions in quiescence search can reach past max_depth
+		constexpr int max_mate_ply{2*max_depth};
+
+		[[nodiscard]] bool is_mate_score(const int score) noexcept
+		{
+			return std::abs(score)>=mate_score-max_mate_ply;
+		}
+
+		// below every mate, shorter conversions score higher
+		constexpr int tablebase_win_score{mate_score-2*max_mate_ply};
+
+		[[nodiscard]] bool is_decisive_score(const int score) noexcept
+		{
+			return std::abs(score)>=tablebase_win_score-max_mate_ply;
+		}
+
+		// positive while mating, negative while being mated
+		[[nodiscard]] int mate_in_moves(const int score) noexcept
+		{
+			return score>0? (mate_score-score+1)/2 : -(mate_score+score)/2;
+		}
+
+		// a tablebase win is reported in centipawns, far above any evaluation and shrinking with the distance to the
+		// conversion like the internal score does
+		[[nodiscard]] int tablebase_win_centipawns(const int score) noexcept
+		{
+			constexpr int tablebase_win_centipawns{20000};
+			const int ply{tablebase_win_score-std::abs(score)};
+			return score>0? tablebase_win_centipawns-ply : -(tablebase_win_centipawns-ply);
+		}
+
+		// decisive scores count plies from the root, the table stores them counted from the entry's position
+		// so a transposition at another ply reports the right distance
+		[[nodiscard]] int to_transposition_score(const int score, const unsigned ply) noexcept
+		{
+			if(!is_decisive_score(score))
+				return score;
+			return score>0? score+static_cast<int>(ply) : score-static_cast<int>(ply);
+		}
+
+		[[nodiscard]] int from_transposition_score(const int score, const unsigned ply) noexcept
+		{
+			if(!is_decisive_score(score))
+				return score;
+			return score>0? score-static_cast<int>(ply) : score+static_cast<int>(ply);
+		}
+
+		[[nodiscard]] int network_evaluation(const Search_context& context) noexcept
+		{
+			return context.state.evaluate(context.neural_network, context.accumulators.current(context.state, context.neural_network));
+		}
+
+		// kept clear of mate and tablebase scores, which are exact
+		[[nodiscard]] int corrected_evaluation(const Search_context& context, const int static_evaluation) noexcept
+		{
+			constexpr int max_evaluation{tablebase_win_score-max_mate_ply-1};
+			return std::clamp(static_evaluation+context.correction_history.correction(context.state), -max_evaluation, max_evaluation);
+		}
+
+		[[nodiscard]] std::optional<Transposition_data> probe_transposition_table(const Search_context& context, const unsigned ply)
+		{
+			auto cache_result{context.transposition_table[context.state.zobrist_hash]};
+			if(cache_result)
+				cache_result->eval=from_transposition_score(cache_result->eval, ply);
+			return cache_result;
+		}
+
+		void store_transposition(const Search_context& context, Transposition_data transposition_data, const unsigned ply)
+		{
+			transposition_data.eval=to_transposition_score(transposition_data.eval, ply);
+			context.transposition_table.insert(transposition_data);
+		}
+
+		[[nodiscard]] bool is_out_of_time(const Search_context& context) noexcept
+		{
+			return !context.search_options.depth && !context.search_options.infinite && context.time_manager.used_time()>context.time_manager.maximum();
+		}
+
+		// summing on every node would keep pulling the other threads' counters into this core's cache
+		[[nodiscard]] bool is_over_node_limit(const Search_context& context) noexcept
+		{
+			constexpr std::uint64_t node_limit_check_interval{1024};
+			if(!context.search_options.nodes || (context.node_counters.size()>1 && context.nodes.value()%node_limit_check_interval!=0))
+				return false;
+			return total_nodes(context.node_counters)>*context.search_options.nodes;
+		}
+
+		[[nodiscard]] bool is_noisy(const State& state, const Move& move) noexcept
+		{
+			const bool is_en_passant{state.en_passant_target_square==move.destination_square() && state.sides[state.side_to_move].pieces[Piece::pawn].is_occupied(move.from_square())};
+			return move.is_promotion() || is_en_passant || state.sides[other_side(state.side_to_move)].occupied_squares().is_occupied(move.destination_square());
+		}
+
 		[[nodiscard]] int quiescence_search(const Search_context& context
+										  , const unsigned ply
+										  , const unsigned quiescence_ply
 										  , int alpha
 										  , int beta)
 		{
-			++context.nodes;
+			context.nodes.increment();
+			context.selective_depth=std::max(context.selective_depth, ply);
 
 			if(context.should_stop_searching)
 				throw search_stopped{};
-			if(!context.search_options.depth && context.time_manager.used_time()>context.time_manager.maximum())
+			if(is_out_of_time(context))
 				throw timeout{};
+			if(is_over_node_limit(context))
+				throw node_limit_reached{};
 
-			const int stand_pat{context.state.evaluate(context.neural_network, context.accumulator)};
-			int best_score=stand_pat;
-			if(stand_pat>=beta || context.extended_depth > 19)
-				return stand_pat;
-			if(alpha<stand_pat)
-				alpha=stand_pat;
+			const int original_alpha{alpha};
+			const auto cache_result{probe_transposition_table(context, ply)};
+			if(cache_result)
+			{
+				const bool is_cutoff{cache_result->search_result_type==Search_result_type::exact
+								  || (cache_result->search_result_type==Search_result_type::lower_bound && cache_result->eval>=beta)
+								  || (cache_result->search_result_type==Search_result_type::upper_bound && cache_result->eval<=alpha)};
+				if(is_cutoff)
+					return cache_result->eval;
+			}
 
-			for(const auto& move : generate_moves<Moves_type::noisy>(context.state))
+			// there is no standing pat in check, every evasion has to be searched
+			const bool in_check{context.state.in_check()};
+			int stand_pat{-std::numeric_limits<int>::max()}, static_evaluation{Transposition_data::no_static_evaluation};
+			if(!in_check)
+			{
+				// a stored evaluation saves bringing the accumulator up to date and running the network
+				static_evaluation=cache_result && cache_result->static_evaluation!=Transposition_data::no_static_evaluation? cache_result->static_evaluation : network_evaluation(context);
+				stand_pat=corrected_evaluation(context, static_evaluation);
+				if(stand_pat>=beta)
+					return stand_pat;
+				if(alpha<stand_pat)
+					alpha=stand_pat;
+			}
+
+			const bool is_searching_quiet_checks{!in_check && quiescence_ply==0};
+			auto moves{in_check || is_searching_quiet_checks? generate_moves<Moves_type::legal>(context.state) : generate_moves<Moves_type::noisy>(context.state)};
+			if(is_searching_quiet_checks)
+				moves.erase_if([&](const Move& move){ return !is_noisy(context.state, move) && !gives_check(context.state, move); });
+
+			Move best_move{};
+			int best_score{stand_pat};
+			for(const auto& move : moves)
 			{
 				constexpr int safety_margin{chess_data::piece_values[Piece::pawn]*2};
-				if(std::optional<Piece> piece_to_capture{context.state.piece_at(move.destination_square(), other_side(context.state.side_to_move))}; piece_to_capture && stand_pat+chess_data::piece_values[piece_to_capture.value()]+safety_margin<=alpha)
+				if(std::optional<Piece> piece_to_capture{context.state.piece_at(move.destination_square(), other_side(context.state.side_to_move))}; !in_check && piece_to_capture && stand_pat+chess_data::piece_values[piece_to_capture.value()]+safety_margin<=alpha)
 					continue;
 
-				make(context.state, context.accumulator, move, context.neural_network);
-				const int score{-quiescence_search(context, -beta, -alpha)};
-				unmove(context.state, context.accumulator, context.neural_network);
+				make(context.state, context.accumulators, move);
+				const int score{-quiescence_search(context, ply+1, quiescence_ply+1, -beta, -alpha)};
+				unmove(context.state, context.accumulators);
 
-				if(score>=beta)
-					return score;
 				if(score>best_score)
+				{
 					best_score=score;
+					best_move=move;
+				}
 				if(score>alpha)
+				{
 					alpha=score;
+					if(alpha>=beta)
+						break;
+				}
+			}
+
+			if(in_check && moves.empty())
+				return -mate_score+static_cast<int>(ply);
+
+			// never replace a deeper result for the same position with a quiescence one
+			if(!cache_result || cache_result->remaining_depth==0)
+			{
+				store_transposition(context, Transposition_data
+				{
+					.remaining_depth=0,
+					.eval=best_score,
+					.zobrist_hash=context.state.zobrist_hash,
+					.search_result_type=compute_type(original_alpha, beta, best_score),
+					.best_move=best_move,
+					.static_evaluation=static_evaluation
+				}, ply);
 			}
 			return best_score;
 		}
@@ -110,11 +269,21 @@ namespace engine
 		{
 			const Search_context& search_context;
 			const Fixed_capacity_vector<Move, 256>& principal_variation;
-			Transposition_table& transposition_table;
+			const Fixed_capacity_vector<Move, 256>& excluded_root_moves;
+			const Fixed_capacity_vector<Move, max_legal_moves>& tablebase_root_moves;
 
 			std::vector<Killer_move_storage> killer_moves{max_depth};
 		};
 
+		[[nodiscard]] bool is_searchable_root_move(const Nega_max_context& context, const Move& move) noexcept
+		{
+			const auto& searchmoves{context.search_context.search_options.searchmoves};
+			const bool is_excluded{std::ranges::find(context.excluded_root_moves, move)!=context.excluded_root_moves.end()},
+					   is_searchmove{searchmoves.empty() || std::ranges::find(searchmoves, move)!=searchmoves.end()},
+					   keeps_tablebase_result{context.tablebase_root_moves.empty() || std::ranges::find(context.tablebase_root_moves, move)!=context.tablebase_root_moves.end()};
+			return is_searchmove && !is_excluded && keeps_tablebase_result;
+		}
+
 		[[nodiscard]] bool most_valuable_vicitim_least_valuable_attacker(const Nega_max_context& context, const Move& lhs, const Move& rhs) noexcept
 		{
 			const auto lhs_victim_value = std::to_underlying(context.search_context.state.piece_at(lhs.destination_square(), other_side(context.search_context.state.side_to_move)).value());
@@ -131,7 +300,7 @@ namespace engine
 			return false;
 		};
 
-		[[nodiscard]] bool heuristic_less(const Nega_max_context& context, const auto& cache_result, const int depth, const int remaining_depth, const Move& lhs, const Move& rhs) noexcept
+		[[nodiscard]] bool heuristic_less(const Nega_max_context& context, const auto& cache_result, const unsigned ply, const int remaining_depth, const Move& lhs, const Move& rhs) noexcept
 		{
 			if(cache_result)
 			{
@@ -144,7 +313,7 @@ namespace engine
 					return false;
 			}
 
-			if(const auto pv_index=depth-remaining_depth; pv_index<context.principal_variation.size())
+			if(const auto pv_index=ply; pv_index<context.principal_variation.size())
 			{
 				const auto pv_move=context.principal_variation.at(pv_index);
 				const bool lhs_is_pv_move=lhs == pv_move,
@@ -223,31 +392,48 @@ namespace engine
 			return reduction;
 		}
 
+		// pv nodes search a full window and can become the principal variation, every other node searches a null window,
+		// the root has its own search
+		enum class Node_type { pv, non_pv };
+
+		template <Node_type node_type>
 		[[nodiscard]] int nega_scout(Nega_max_context& context
 								   , Fixed_capacity_vector<Move, 256>& current_pv
-								   , const unsigned remaining_depth
-								   , const unsigned depth
+								   , unsigned remaining_depth
+								   , const unsigned ply
 								   , unsigned number_of_checks_in_current_line
 								   , int alpha = -std::numeric_limits<int>::max()
 								   , int beta = std::numeric_limits<int>::max())
 		{
-			++context.search_context.nodes;
+			constexpr bool is_pv_node{node_type==Node_type::pv};
+			constexpr Node_type full_window_child_type{is_pv_node? Node_type::pv : Node_type::non_pv};
+
+			context.search_context.nodes.increment();
+			context.search_context.selective_depth=std::max(context.search_context.selective_depth, ply);
 
 			current_pv.clear();
 
 			if(is_threefold_repetition(context.search_context.state))
 				return 0;
-			if(!context.search_context.search_options.depth && context.search_context.time_manager.used_time()>context.search_context.time_manager.maximum())
+			if(is_out_of_time(context.search_context))
 				throw timeout{};
+			if(is_over_node_limit(context.search_context))
+				throw node_limit_reached{};
+
+			// no line from here can beat a mate already found closer to the root
+			alpha=std::max(alpha, -mate_score+static_cast<int>(ply));
+			beta=std::min(beta, mate_score-static_cast<int>(ply)-1);
+			if(alpha>=beta)
+				return alpha;
 
 			auto all_legal_moves = generate_moves<Moves_type::legal>(context.search_context.state);
 			if(remaining_depth<=0 && !all_legal_moves.empty())
-				return quiescence_search(context.search_context, alpha, beta);
+				return quiescence_search(context.search_context, ply, 0, alpha, beta);
 
 			Move best_move{};
 			int best_score{-std::numeric_limits<int>::max()};
 			const int original_alpha{alpha};
-			const auto cache_result{context.transposition_table[context.search_context.state.zobrist_hash]};
+			const auto cache_result{probe_transposition_table(context.search_context, ply)};
 			if(cache_result && cache_result->remaining_depth>=remaining_depth)
 			{
 				if(cache_result->search_result_type == Search_result_type::exact)
@@ -267,31 +453,105 @@ namespace engine
 					return cache_result->eval;
 			}
 
-			const auto sort_move_strength_descending{[&](const Move& lhs, const Move& rhs){ return heuristic_less(context,cache_result,depth,remaining_depth,lhs,rhs); }};
+			// interior nodes never evaluate, an evaluation is only known when a visit to the position as a quiescence node stored one
+			const int static_evaluation{cache_result? cache_result->static_evaluation : Transposition_data::no_static_evaluation};
+
+			// only probed right after a capture or pawn move, where the 50 move rule can not change the stored result
+			if(context.search_context.state.half_move_clock==0 && context.search_context.tablebases.can_probe(context.search_context.state))
+			{
+				if(const auto wdl{context.search_context.tablebases.probe_wdl(context.search_context.state)})
+				{
+					context.search_context.tbhits.increment();
+					const int score{*wdl==syzygy::Wdl::win? tablebase_win_score-static_cast<int>(ply) : *wdl==syzygy::Wdl::loss? -tablebase_win_score+static_cast<int>(ply) : 0};
+					const Search_result_type search_result_type{*wdl==syzygy::Wdl::win? Search_result_type::lower_bound : *wdl==syzygy::Wdl::loss? Search_result_type::upper_bound : Search_result_type::exact};
+					if(search_result_type==Search_result_type::exact
+					|| (search_result_type==Search_result_type::lower_bound && score>=beta)
+					|| (search_result_type==Search_result_type::upper_bound && score<=alpha))
+					{
+						constexpr unsigned tablebase_depth_bonus{6};
+						store_transposition(context.search_context, Transposition_data
+						{
+							.remaining_depth=std::min<unsigned>(remaining_depth+tablebase_depth_bonus, max_depth-1),
+							.eval=score,
+							.zobrist_hash=context.search_context.state.zobrist_hash,
+							.search_result_type=search_result_type,
+							.best_move=Move{},
+							.static_evaluation=static_evaluation
+						}, ply);
+						return score;
+					}
+				}
+			}
+
+			const bool in_check{context.search_context.state.in_check()};
+
+			// a capture that beats beta by a margin at a much lower depth almost always does so at full depth,
+			// unless the table already shows that this position failed to do so recently
+			constexpr unsigned probcut_depth{5}, probcut_reduction{4};
+			const int probcut_beta{beta+chess_data::piece_values[Piece::pawn]*2};
+			const bool is_probcut_refuted{cache_result && cache_result->remaining_depth+probcut_reduction-1>=remaining_depth && cache_result->eval<probcut_beta};
+			if(!is_pv_node && !in_check && remaining_depth>=probcut_depth && !is_mate_score(beta) && !is_probcut_refuted)
+			{
+				Fixed_capacity_vector<Move, 256> probcut_pv;
+				for(const Move& move : all_legal_moves)
+				{
+					if(!is_noisy(context.search_context.state, move) || static_exchange_evaluation(context.search_context.state, move)<0)
+						continue;
+
+					make(context.search_context.state, context.search_context.accumulators, move);
+
+					// quiescence search rejects most captures before paying for the reduced depth search
+					int score{-quiescence_search(context.search_context, ply+1, 0, -probcut_beta, -probcut_beta+1)};
+					if(score>=probcut_beta)
+						score=-nega_scout<Node_type::non_pv>(context, probcut_pv, remaining_depth-probcut_reduction, ply+1, number_of_checks_in_current_line, -probcut_beta, -probcut_beta+1);
+
+					unmove(context.search_context.state, context.search_context.accumulators);
+
+					if(score>=probcut_beta)
+					{
+						store_transposition(context.search_context, Transposition_data
+						{
+							.remaining_depth=remaining_depth-probcut_reduction+1,
+							.eval=score,
+							.zobrist_hash=context.search_context.state.zobrist_hash,
+							.search_result_type=Search_result_type::lower_bound,
+							.best_move=move,
+							.static_evaluation=static_evaluation
+						}, ply);
+						return score;
+					}
+				}
+			}
+
+			// without a cached move the first move searched is usually poor, so the node is searched shallower rather than at full cost
+			constexpr unsigned internal_iterative_reduction_depth{4};
+			if(remaining_depth>=internal_iterative_reduction_depth && (!cache_result || cache_result->best_move==Move{}))
+				--remaining_depth;
+
+			const auto sort_move_strength_descending{[&](const Move& lhs, const Move& rhs){ return heuristic_less(context,cache_result,ply,remaining_depth,lhs,rhs); }};
 			std::ranges::sort(all_legal_moves, sort_move_strength_descending);
 
-			const bool in_check{context.search_context.state.in_check()},  is_null_window{std::abs(original_alpha-beta)<=1};
 			Child_pv_storage child_pvs;
 			for(unsigned move_index{0}; move_index<all_legal_moves.size(); ++move_index)
 			{
 				const Move& move{all_legal_moves[move_index]};
 
-				if(!context.search_context.search_options.depth && context.search_context.time_manager.used_time()>context.search_context.time_manager.maximum())
+				if(is_out_of_time(context.search_context))
 					throw timeout{};
 
 				const unsigned reduction{compute_reduction(in_check,number_of_checks_in_current_line,move_index,remaining_depth)};
 
-				make(context.search_context.state, context.search_context.accumulator, move,context.search_context.neural_network);
+				make(context.search_context.state, context.search_context.accumulators, move);
 
 				int score{0};
 				struct { int alpha, beta; } null_window{alpha, alpha+1};
 				if(move_index>0)
-					score=-nega_scout(context,child_pvs.inferior_child_pv(),remaining_depth-reduction,depth,number_of_checks_in_current_line+in_check,-null_window.beta,-null_window.alpha);
+					score=-nega_scout<Node_type::non_pv>(context,child_pvs.inferior_child_pv(),remaining_depth-reduction,ply+1,number_of_checks_in_current_line+in_check,-null_window.beta,-null_window.alpha);
 
 				if(move_index==0 || score>alpha)
-					score=-nega_scout(context,child_pvs.inferior_child_pv(),remaining_depth-1,depth,number_of_checks_in_current_line+in_check,-beta,-alpha);
+					score=-nega_scout<full_window_child_type>(context,child_pvs.inferior_child_pv(),remaining_depth-1,ply+1,number_of_checks_in_current_line+in_check,-beta,-alpha);
 
-				unmove(context.search_context.state, context.search_context.accumulator, context.search_context.neural_network);
+				unmove(context.search_context.state, context.search_context.accumulators);
 
 				if(score>best_score)
 				{
@@ -314,7 +574,7 @@ namespace engine
 			if(all_legal_moves.empty())
 			{
 				if(in_check)
-					return -std::numeric_limits<int>::max()+10000;
+					return -mate_score+static_cast<int>(ply);
 				else
 					return 0;
 			}
@@ -322,25 +582,37 @@ namespace engine
 			current_pv.push_back(best_move);
 			current_pv.insert(current_pv.end(), child_pvs.best_child_pv().begin(), child_pvs.best_child_pv().end());
 
+			// a bound only says which way the evaluation was wrong when it lies on the far side of it,
+			// and a capture's result says more about the capture than about the position
+			if(!in_check && static_evaluation!=Transposition_data::no_static_evaluation && !is_decisive_score(best_score) && !is_noisy(context.search_context.state, best_move))
+			{
+				const Search_result_type search_result_type{compute_type(original_alpha, beta, best_score)};
+				if(!(search_result_type==Search_result_type::lower_bound && best_score<=static_evaluation)
+				&& !(search_result_type==Search_result_type::upper_bound && best_score>=static_evaluation))
+					context.search_context.correction_history.update(context.search_context.state, remaining_depth, best_score-static_evaluation);
+			}
+
 			alpha=std::min(alpha,beta);
 
-			if(!is_null_window)
+			// null window results are stored as well, the table keeps the deeper entry when they compete for a slot
+			store_transposition(context.search_context, Transposition_data
 			{
-				context.transposition_table.insert(Transposition_data
-				{
-					.remaining_depth=remaining_depth,
-					.eval=alpha,
-					.zobrist_hash=context.search_context.state.zobrist_hash,
-					.search_result_type=compute_type(original_alpha, beta, best_score),
-					.best_move=best_move
-				});
-			}
+				.remaining_depth=remaining_depth,
+				.eval=alpha,
+				.zobrist_hash=context.search_context.state.zobrist_hash,
+				.search_result_type=compute_type(original_alpha, beta, best_score),
+				.best_move=best_move,
+				.static_evaluation=static_evaluation
+			}, ply);
 
 			return alpha;
 		};
 
-		void output_info(const int& eval, const auto& nodes, const auto& current_depth, const auto& principal_variation, const Stdio& io, const int thread_id) noexcept
+		void output_info(const Search_context& context, const int& eval, const unsigned current_depth, const std::size_t multipv, const auto& principal_variation, const Stdio& io) noexcept
 		{
+			const std::uint64_t nodes{total_nodes(context.node_counters)}, tbhits{total_nodes(context.tbhit_counters)};
+			const std::chrono::milliseconds time{context.time_manager.used_time()};
+			const std::uint64_t nps{nodes*1000/std::max<std::uint64_t>(time.count(), 1)};
 			const auto output = [&](std::string_view info)
 			{
 				bool first{true};
@@ -353,89 +625,272 @@ namespace engine
 				}
 				io.output(info, pv.str());
 			};
-			if(std::abs(eval)!=std::numeric_limits<int>::max())
-				output(std::format("info [Thread {}] score cp {} nodes {} depth {} pv ", thread_id, eval/16, nodes, current_depth));
-			else
-				output(std::format("info [Thread {}] nodes {} depth {} mate ", thread_id, nodes, current_depth));
+			const std::string score{is_mate_score(eval)? std::format("mate {}", mate_in_moves(eval))
+								   : is_decisive_score(eval)? std::format("cp {}", tablebase_win_centipawns(eval))
+								   : std::format("cp {}", eval/16)};
+			output(std::format("info depth {} seldepth {} multipv {} score {} nodes {} nps {} hashfull {} tbhits {} time {} pv ", current_depth, context.selective_depth, multipv, score, nodes, nps, context.transposition_table.hashfull(), tbhits, time.count()));
 		};
+
+		// kept across iterations, moves that failed low only have an upper bound and score below every other move
+		struct Root_move
+		{
+			Move move{};
+			int score{-std::numeric_limits<int>::max()}, previous_score{-std::numeric_limits<int>::max()};
+			std::uint64_t nodes{0};
+			Fixed_capacity_vector<Move, 256> pv{};
+		};
+
+		// the best scores first, a move that took more effort to refute is more likely to become the best
+		[[nodiscard]] bool root_move_greater(const Root_move& lhs, const Root_move& rhs) noexcept
+		{
+			return std::tie(lhs.score, lhs.nodes)>std::tie(rhs.score, rhs.nodes);
+		}
+
+		// the root searches its own move list in the order of the last iteration, never cutting off on or overwriting
+		// the table entry so searchmoves and secondary multipv lines can not leave a partial result behind
+		[[nodiscard]] int search_root(Nega_max_context& context
+									, std::vector<Root_move>& root_moves
+									, Fixed_capacity_vector<Move, 256>& current_pv
+									, const unsigned depth
+									, int alpha
+									, const int beta)
+		{
+			context.search_context.nodes.increment();
+			current_pv.clear();
+
+			const bool in_check{context.search_context.state.in_check()};
+			int best_score{-std::numeric_limits<int>::max()};
+			unsigned move_index{0};
+			Fixed_capacity_vector<Move, 256> child_pv;
+			for(auto& root_move : root_moves)
+			{
+				if(!is_searchable_root_move(context, root_move.move))
+					continue;
+				if(is_out_of_time(context.search_context))
+					throw timeout{};
+
+				const std::uint64_t nodes_before{context.search_context.nodes.value()};
+				const unsigned reduction{compute_reduction(in_check, 0, move_index, depth)};
+
+				make(context.search_context.state, context.search_context.accumulators, root_move.move);
+
+				int score{0};
+				if(move_index>0)
+					score=-nega_scout<Node_type::non_pv>(context, child_pv, depth-reduction, 1, in_check, -alpha-1, -alpha);
+				if(move_index==0 || score>alpha)
+					score=-nega_scout<Node_type::pv>(context, child_pv, depth-1, 1, in_check, -beta, -alpha);
+
+				unmove(context.search_context.state, context.search_context.accumulators);
+
+				root_move.nodes+=context.search_context.nodes.value()-nodes_before;
+				if(move_index==0 || score>alpha)
+				{
+					root_move.score=score;
+					root_move.pv.clear();
+					root_move.pv.push_back(root_move.move);
+					root_move.pv.insert(root_move.pv.end(), child_pv.begin(), child_pv.end());
+				}
+				else
+					root_move.score=-std::numeric_limits<int>::max();
+				++move_index;
+
+				if(score>best_score)
+				{
+					best_score=score;
+					current_pv=root_move.pv;
+				}
+				if(score>alpha)
+				{
+					alpha=score;
+					if(alpha>=beta)
+						break;
+				}
+			}
+
+			if(move_index==0)
+				return in_check? -mate_score : 0;
+			return best_score;
+		}
 	}
 
 	std::expected<Search_results, search_stopped> iterative_deepening(const std::atomic<bool>& should_stop_searching
+														 , std::span<Node_counter> node_counters
+														 , std::span<Node_counter> tbhit_counters
+														 , std::span<Correction_history> correction_histories
 														 , const Search_options& search_options
 														 , State state
 														 , Transposition_table& transposition_table
 														 , const Neural_network& neural_network
+														 , const syzygy::Tablebases& tablebases
 														 , const int thread_id) noexcept
 	{
 		static Stdio io;
 		Time_manager time_manager(search_options.time[state.side_to_move], search_options.movetime, search_options.increment[state.side_to_move], search_options.move_overhead, search_options.movestogo, state.half_move_clock);
-		Fixed_capacity_vector<Move, 256> principal_variation;
+		Fixed_capacity_vector<Move, 256> principal_variation, excluded_root_moves;
+
+		Accumulator_stack accumulators{state, neural_network};
 
-		Accumulator accumulator{fresh_accumulator(state, neural_network)};
+		int score{state.evaluate(neural_network, accumulators.current(state, neural_network))};
+		unsigned selective_depth{0};
 
-		int score{state.evaluate(neural_network, accumulator)};
-		unsigned nodes{0}, extended_depth{0};
+		// in a tablebase position only the moves that keep the best result are searched, unless the moves are given
+		Fixed_capacity_vector<Move, max_legal_moves> tablebase_root_moves{};
+		if(search_options.searchmoves.empty())
+		{
+			if(auto best_root_moves{tablebases.best_root_moves(state)})
+			{
+				tablebase_root_moves=*best_root_moves;
+				tbhit_counters[thread_id].increment();
+			}
+		}
 
 		Nega_max_context nega_max_context
 		{
 			.search_context=Search_context
 			{
 				state,
-				accumulator,
-				nodes,
-				extended_depth,
+				accumulators,
+				node_counters[thread_id],
+				tbhit_counters[thread_id],
+				correction_histories[thread_id],
+				selective_depth,
+				transposition_table,
 				should_stop_searching,
+				node_counters,
+				tbhit_counters,
 				search_options,
 				time_manager,
-				neural_network
+				neural_network,
+				tablebases
 			},
 			.principal_variation=principal_variation,
-			.transposition_table=transposition_table
+			.excluded_root_moves=excluded_root_moves,
+			.tablebase_root_moves=tablebase_root_moves
 		};
 
 		Fixed_capacity_vector<engine::Move, 256> current_pv{};
 
-		unsigned current_depth{1};
-		for(; search_options.depth? current_depth <= *search_options.depth : current_depth<=max_depth && time_manager.used_time()<time_manager.optimum(); ++current_depth)
+		std::vector<Root_move> root_moves;
 		{
-			extended_depth=nodes=0;
-			try
-			{
-				constexpr int half_initial_window_size{chess_data::piece_values[Piece::pawn]/4};
-				int alpha{score-half_initial_window_size}, beta{score+half_initial_window_size};
-
-
-				// oh dear!!
-				if(alpha>=beta) alpha=-std::numeric_limits<int>::max(), beta=std::numeric_limits<int>::max();
+			auto moves{generate_moves<Moves_type::legal>(state)};
+			moves.erase_if([&](const Move& move){ return !is_searchable_root_move(nega_max_context, move); });
+			const auto cache_result{transposition_table[state.zobrist_hash]};
+			std::ranges::sort(moves, [&](const Move& lhs, const Move& rhs){ return heuristic_less(nega_max_context, cache_result, 0, 0, lhs, rhs); });
+			for(const auto& move : moves)
+				root_moves.push_back(Root_move{.move=move, .score=score, .previous_score=score});
+		}
+		// checkmate or stalemate, there is nothing to search
+		if(root_moves.empty())
+		{
+			score=state.in_check()? -mate_score : 0;
+			if(thread_id==main_thread_id)
+				output_info(nega_max_context.search_context, score, 0, 1, principal_variation, io);
+		}
+		const std::size_t number_of_lines{std::clamp<std::size_t>(search_options.multipv, 1, std::max<std::size_t>(root_moves.size(), 1))};
 
+		// a mate in n moves is found within 2n-1 plies
+		const std::optional<unsigned> depth_limit{search_options.mate? std::min(search_options.depth.value_or(max_depth), 2**search_options.mate-1) : search_options.depth};
+		const auto should_start_iteration=[&](const unsigned current_depth)
+		{
+			if(search_options.nodes && total_nodes(node_counters)>=*search_options.nodes)
+				return false;
+			const bool has_mate{!principal_variation.empty() && is_mate_score(score)};
+			if(search_options.mate && has_mate && mate_in_moves(score)>0 && mate_in_moves(score)<=static_cast<int>(*search_options.mate))
+				return false;
+			if(depth_limit)
+				return current_depth<=*depth_limit;
+			if(search_options.infinite)
+				return current_depth<=max_depth;
+			// a forced move or a mate in one cannot be improved on, the time is saved for later moves
+			if(current_depth>1 && (root_moves.size()==1 || (has_mate && score==mate_score-1)))
+				return false;
+			// once the searched depth is well past the mate, a shorter one is unlikely to turn up
+			if(has_mate && current_depth>2*static_cast<unsigned>(mate_score-std::abs(score)))
+				return false;
+			return current_depth<=max_depth && time_manager.can_start_iteration();
+		};
 
-				Search_result_type last_search_result_type;
-				do
+		for(unsigned current_depth{1}; !root_moves.empty() && should_start_iteration(current_depth); ++current_depth)
+		{
+			selective_depth=0;
+			const std::chrono::milliseconds iteration_start_time{time_manager.used_time()};
+			for(auto& root_move : root_moves)
+			{
+				root_move.previous_score=root_move.score;
+				root_move.nodes=0;
+			}
+			try
+			{
+				excluded_root_moves.clear();
+				for(std::size_t line_index{0}; line_index<number_of_lines; ++line_index)
 				{
-					score=nega_scout(nega_max_context,current_pv,current_depth,current_depth,0,alpha,beta);
+					constexpr int half_initial_window_size{chess_data::piece_values[Piece::pawn]/4};
+					const int previous_score{root_moves[line_index].previous_score};
+					int alpha{-std::numeric_limits<int>::max()}, beta{std::numeric_limits<int>::max()}, line_score;
+					// a move that failed low last iteration has no score to centre a window on
+					if(previous_score!=-std::numeric_limits<int>::max())
+						alpha=std::max(previous_score, alpha+half_initial_window_size)-half_initial_window_size, beta=std::min(previous_score, beta-half_initial_window_size)+half_initial_window_size;
 
-					last_search_result_type=compute_type(alpha, beta, score);
-					if(last_search_result_type==Search_result_type::lower_bound)
-						beta=std::numeric_limits<int>::max();
-					if(last_search_result_type==Search_result_type::upper_bound)
-						alpha=-std::numeric_limits<int>::max();
-				} while(last_search_result_type!=Search_result_type::exact);
 
-				principal_variation=current_pv;
-				output_info(score, nodes, current_depth, principal_variation, io, thread_id);
+					Search_result_type last_search_result_type;
+					do
+					{
+						line_score=search_root(nega_max_context,root_moves,current_pv,current_depth,alpha,beta);
+						// a move that failed high is searched first when the window is widened
+						std::ranges::stable_sort(root_moves, root_move_greater);
+
+						last_search_result_type=compute_type(alpha, beta, line_score);
+						if(last_search_result_type==Search_result_type::lower_bound)
+							beta=std::numeric_limits<int>::max();
+						if(last_search_result_type==Search_result_type::upper_bound)
+							alpha=-std::numeric_limits<int>::max();
+					} while(last_search_result_type!=Search_result_type::exact);
+
+					if(!current_pv.empty())
+						excluded_root_moves.push_back(current_pv.front());
+				}
+				excluded_root_moves.clear();
+
+				// a later line can resolve above an earlier one, the best line is always reported first
+				std::ranges::stable_sort(root_moves, root_move_greater);
+				const Root_move& best_root_move{root_moves.front()};
+				const bool best_move_changed{principal_variation.empty() || principal_variation.front()!=best_root_move.move};
+				const int score_drop{static_cast<int>(std::clamp<std::int64_t>((std::int64_t{score}-best_root_move.score)/16, -mate_score/16, mate_score/16))};
+				const std::uint64_t iteration_nodes{std::transform_reduce(root_moves.begin(), root_moves.end(), std::uint64_t{0}, std::plus<>{}, [](const Root_move& root_move){ return root_move.nodes; })};
+				const double best_move_node_fraction{static_cast<double>(best_root_move.nodes)/std::max<std::uint64_t>(iteration_nodes, 1)};
+				time_manager.update(time_manager.used_time()-iteration_start_time, best_move_changed, score_drop, best_move_node_fraction);
+				score=best_root_move.score;
+				principal_variation=best_root_move.pv;
+				if(thread_id==main_thread_id)
+				{
+					for(std::size_t line_index{0}; line_index<number_of_lines; ++line_index)
+						output_info(nega_max_context.search_context, root_moves[line_index].score, current_depth, line_index+1, root_moves[line_index].pv, io);
+				}
 			}
 			catch(const timeout&)
 			{
 
+			}
+			catch(const node_limit_reached&)
+			{
+				break;
 			}
 			catch(const search_stopped&)
 			{
-				return std::unexpected{search_stopped{}};
+				break;
 			}
 		}
 
+		// a search cut short in its first iteration still has to play something, the root moves are ordered best first
+		if(principal_variation.empty() && !root_moves.empty())
+			principal_variation.push_back(root_moves.front().move);
+
+		// in infinite mode the best move may only be reported once the gui stops the search
+		while(search_options.infinite && !should_stop_searching)
+			std::this_thread::sleep_for(std::chrono::milliseconds{1});
+
 		return Search_results {
-			.nodes=nodes,
+			.nodes=total_nodes(node_counters),
 			.score=score,
 			.pv=principal_variation,
 		};
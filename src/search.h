@@ -2,20 +2,53 @@
 #define search_h_INCLUDED
 
 #include "Constants.h"
+#include "Correction_history.h"
 #include "Fixed_capacity_vector.h"
 #include "Move.h"
+#include "Syzygy.h"
 #include "Transposition_table.h"
 
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <expected>
+#include <numeric>
 #include <optional>
+#include <span>
+#include <vector>
 
 namespace engine
 {
+	constexpr int main_thread_id{0};
+
+	// each thread only writes its own counter, padded to a cache line so that counting never contends
+	class alignas(cache_line_size) Node_counter
+	{
+		public:
+
+		inline void increment() noexcept
+		{
+			nodes.store(nodes.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] inline std::uint64_t value() const noexcept
+		{
+			return nodes.load(std::memory_order_relaxed);
+		}
+
+		private:
+
+		std::atomic<std::uint64_t> nodes{0};
+	};
+
+	[[nodiscard]] inline std::uint64_t total_nodes(std::span<const Node_counter> node_counters) noexcept
+	{
+		return std::transform_reduce(node_counters.begin(), node_counters.end(), std::uint64_t{0}, std::plus<>{}, [](const Node_counter& node_counter){ return node_counter.value(); });
+	}
+
 	struct Search_results
 	{
-		unsigned nodes{0};
+		std::uint64_t nodes{0};
 		int score{0};
 		Fixed_capacity_vector<Move, 256> pv;
 	};
@@ -23,12 +56,17 @@ namespace engine
 	struct Search_options
 	{
 		std::optional<unsigned> depth{std::nullopt};
+		std::optional<std::uint64_t> nodes{std::nullopt};
+		std::optional<unsigned> mate{std::nullopt};
+		bool infinite{false};
+		std::vector<Move> searchmoves{};
 		unsigned movestogo{0};
 		engine::Side_map<std::optional<std::chrono::milliseconds>> time{std::nullopt, std::nullopt};
 		engine::Side_map<std::chrono::milliseconds> increment{std::chrono::milliseconds{0}, std::chrono::milliseconds{0}};
 		std::optional<std::chrono::milliseconds> movetime{std::nullopt};
 		std::chrono::milliseconds move_overhead{default_move_overhead};
 		int threads{default_threads};
+		unsigned multipv{default_multipv};
 	};
 
 	enum class timeout {};
@@ -37,10 +75,14 @@ namespace engine
 	[[nodiscard]]
 	std::expected<Search_results, search_stopped>
 	iterative_deepening(const std::atomic<bool>& should_stop_searching
+		   , std::span<Node_counter> node_counters
+		   , std::span<Node_counter> tbhit_counters
+		   , std::span<Correction_history> correction_histories
 		   , const Search_options& search_options
 		   , State state
 		   , Transposition_table& transposition_table
 		   , const Neural_network& neural_network
+		   , const syzygy::Tablebases& tablebases
 		   , const int thread_id) noexcept;
 } // namespace engine
 
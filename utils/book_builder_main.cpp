@@ -0,0 +1,78 @@
+#include "Book_builder.h"
+#include "Memory_mapped_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <ranges>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace engine;
+
+int main(int argc, char* argv[])
+{
+	if(argc<5)
+	{
+		std::cerr<<"Usage: book_builder <book> <max ply> <min games> <pgn files...>\n";
+		return 1;
+	}
+	const std::string_view book_path{argv[1]};
+	const auto max_ply{static_cast<unsigned>(std::atoi(argv[2]))};
+	const auto min_games{static_cast<unsigned>(std::atoi(argv[3]))};
+	const unsigned thread_count{std::max(std::thread::hardware_concurrency(), 1U)};
+
+	std::vector<Memory_mapped_file> files;
+	std::vector<std::string_view> chunks;
+	for(int arg{4}; arg<argc; ++arg)
+	{
+		auto file{Memory_mapped_file::open(argv[arg])};
+		if(!file)
+		{
+			std::cerr<<"could not open "<<argv[arg]<<"\n";
+			return 1;
+		}
+		const std::string_view text{reinterpret_cast<const char*>(file->bytes().data()), file->bytes().size()};
+		// a few chunks a thread so one slow chunk does not hold up the rest
+		std::ranges::copy(book_builder::split_into_chunks(text, 4ULL*thread_count), std::back_inserter(chunks));
+		files.push_back(std::move(*file));
+	}
+
+	std::vector<book_builder::Statistics> statistics(thread_count);
+	std::vector<std::size_t> games(thread_count);
+	{
+		std::atomic<std::size_t> next_chunk{0};
+		std::vector<std::jthread> threads;
+		for(unsigned thread_id{0}; thread_id<thread_count; ++thread_id)
+		{
+			threads.emplace_back([&, thread_id]()
+			{
+				book_builder::Pgn_parser parser{statistics[thread_id], max_ply};
+				for(std::size_t chunk{next_chunk++}; chunk<chunks.size(); chunk=next_chunk++)
+					parser.parse(chunks[chunk]);
+				games[thread_id]=parser.games();
+			});
+		}
+	}
+
+	for(auto& thread_statistics : statistics | std::views::drop(1))
+	{
+		book_builder::merge(statistics.front(), thread_statistics);
+		thread_statistics.clear();
+	}
+
+	const auto entries{book_builder::to_entries(statistics.front(), min_games)};
+	std::ofstream book{std::string{book_path}, std::ios::binary};
+	book_builder::write_book(book, entries);
+	if(!book)
+	{
+		std::cerr<<"could not write "<<book_path<<"\n";
+		return 1;
+	}
+	std::cout<<"games "<<std::accumulate(games.begin(), games.end(), std::size_t{0})<<"\nentries "<<entries.size()<<"\n";
+}